@@ -0,0 +1,383 @@
+// Benchmarks for eass.h against the plain C library
+//
+// Measures print(), string_format(), the array functions and the file helpers at several
+// sizes, next to the libc code they replace, and writes the results as JSON to stdout.
+//
+// Usage: eass_bench [--quick] [--tmp <scratch file>]
+// Build: cc -std=c11 -O2 -I.. eass_bench.c -o eass_bench -pthread -lm
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L // dup(), dup2() and fileno() under -std=c11
+#endif
+#include "eass.h"
+
+#ifdef _WIN32
+#define BENCH_NULL_DEVICE "NUL"
+#define dup _dup
+#define dup2 _dup2
+#define close _close
+#else
+#include <fcntl.h>
+#define BENCH_NULL_DEVICE "/dev/null"
+#endif
+
+#define BENCH_MAX_RESULTS 128
+#define BENCH_REPEATS 5
+
+// Each benchmark runs iterations rounds of its operation at the given size and returns the
+// elapsed seconds
+typedef double (*BenchFn)(size_t size, size_t iterations);
+
+typedef struct {
+    const char* name;
+    const char* impl;
+    size_t size;
+    size_t iterations;
+    double ns_per_op;
+} BenchResult;
+
+static BenchResult bench_results[BENCH_MAX_RESULTS];
+static size_t bench_result_count;
+static double bench_min_time = 0.2; // Seconds each measured run should last
+static const char* bench_tmp_path = "eass_bench.tmp";
+static char bench_text[1 << 20];    // Payload for strings and files
+static volatile size_t bench_sink;  // Keeps results alive so the compiler cannot drop work
+
+static double bench_now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+// A string value print() and string_format() can take ownership of
+static DynamicValue bench_string(size_t size) {
+    char* s = (char*)malloc(size + 1);
+    memcpy(s, bench_text, size);
+    s[size] = '\0';
+    return (DynamicValue){EASS_STRING, 0, .value.s = s};
+}
+
+// Function to time fn, growing the iteration count until a run lasts long enough, then
+// keep the best of several runs
+static void bench_run(const char* name, const char* impl, BenchFn fn, size_t size, size_t ops_per_iteration) {
+    size_t iterations = 1;
+    double elapsed;
+    while ((elapsed = fn(size, iterations)) < bench_min_time / 4 && iterations < ((size_t)1 << 40)) {
+        iterations *= (elapsed > 0) ? (size_t)(bench_min_time / 2 / elapsed) + 2 : 16;
+    }
+    double best = elapsed;
+    for (int i = 1; i < BENCH_REPEATS; i++) {
+        double t = fn(size, iterations);
+        if (t < best) best = t;
+    }
+    if (bench_result_count < BENCH_MAX_RESULTS) {
+        BenchResult* result = &bench_results[bench_result_count++];
+        result->name = name;
+        result->impl = impl;
+        result->size = size;
+        result->iterations = iterations;
+        result->ns_per_op = best * 1e9 / (double)iterations / (double)ops_per_iteration;
+    }
+}
+
+// print() to the console, with the console redirected to the null device
+
+static double bench_print_eass(size_t size, size_t iterations) {
+    double start = bench_now();
+    for (size_t i = 0; i < iterations; i++) {
+        print("item {} of {}: {}", numlit((int)i), numlit(2.5f), bench_string(size));
+    }
+    eass_flush();
+    return bench_now() - start;
+}
+
+static double bench_print_libc(size_t size, size_t iterations) {
+    double start = bench_now();
+    for (size_t i = 0; i < iterations; i++) {
+        printf("item %d of %g: %.*s\n", (int)i, 2.5, (int)size, bench_text);
+    }
+    fflush(stdout);
+    return bench_now() - start;
+}
+
+// print() into memory
+
+static double bench_print_memory_eass(size_t size, size_t iterations) {
+    EassSink sink = eass_sink_memory();
+    double start = bench_now();
+    for (size_t i = 0; i < iterations; i++) {
+        sink.size = 0;
+        print_sink(&sink, "item {} of {}: {}", numlit((int)i), numlit(2.5f), bench_string(size));
+    }
+    double elapsed = bench_now() - start;
+    bench_sink += sink.size;
+    eass_sink_free(&sink);
+    return elapsed;
+}
+
+static double bench_print_memory_libc(size_t size, size_t iterations) {
+    static char buf[sizeof(bench_text) + 64];
+    double start = bench_now();
+    for (size_t i = 0; i < iterations; i++) {
+        bench_sink += (size_t)snprintf(buf, sizeof(buf), "item %d of %g: %.*s\n", (int)i, 2.5, (int)size, bench_text);
+    }
+    return bench_now() - start;
+}
+
+// string_format() into a new heap string
+
+static double bench_string_format_eass(size_t size, size_t iterations) {
+    double start = bench_now();
+    for (size_t i = 0; i < iterations; i++) {
+        char* s = string_format("item {} of {}: {}", numlit((int)i), numlit(2.5f), bench_string(size));
+        bench_sink += s[0];
+        free(s);
+    }
+    return bench_now() - start;
+}
+
+static double bench_string_format_libc(size_t size, size_t iterations) {
+    double start = bench_now();
+    for (size_t i = 0; i < iterations; i++) {
+        int len = snprintf(NULL, 0, "item %d of %g: %.*s", (int)i, 2.5, (int)size, bench_text);
+        char* s = (char*)malloc((size_t)len + 1);
+        snprintf(s, (size_t)len + 1, "item %d of %g: %.*s", (int)i, 2.5, (int)size, bench_text);
+        bench_sink += s[0];
+        free(s);
+    }
+    return bench_now() - start;
+}
+
+// Growing an array one element at a time
+
+static double bench_append_eass(size_t size, size_t iterations) {
+    double start = bench_now();
+    for (size_t i = 0; i < iterations; i++) {
+        DynamicArray arr = array(0);
+        for (size_t j = 0; j < size; j++) {
+            array_append(&arr, numlit((int)j));
+        }
+        bench_sink += arr.size;
+        free_dynamic_array(&arr);
+    }
+    return bench_now() - start;
+}
+
+static double bench_append_libc(size_t size, size_t iterations) {
+    double start = bench_now();
+    for (size_t i = 0; i < iterations; i++) {
+        int* data = NULL;
+        size_t count = 0, capacity = 0;
+        for (size_t j = 0; j < size; j++) {
+            if (count == capacity) {
+                capacity = capacity < 4 ? 4 : capacity + (capacity >> 1);
+                data = (int*)realloc(data, capacity * sizeof(int));
+            }
+            data[count++] = (int)j;
+        }
+        bench_sink += count;
+        free(data);
+    }
+    return bench_now() - start;
+}
+
+// Inserting at the front, which shifts every element
+
+static double bench_insert_eass(size_t size, size_t iterations) {
+    double start = bench_now();
+    for (size_t i = 0; i < iterations; i++) {
+        DynamicArray arr = array(0);
+        for (size_t j = 0; j < size; j++) {
+            array_insert(&arr, 0, numlit((int)j));
+        }
+        bench_sink += arr.size;
+        free_dynamic_array(&arr);
+    }
+    return bench_now() - start;
+}
+
+static double bench_insert_libc(size_t size, size_t iterations) {
+    double start = bench_now();
+    for (size_t i = 0; i < iterations; i++) {
+        int* data = NULL;
+        size_t count = 0, capacity = 0;
+        for (size_t j = 0; j < size; j++) {
+            if (count == capacity) {
+                capacity = capacity < 4 ? 4 : capacity * 2;
+                data = (int*)realloc(data, capacity * sizeof(int));
+            }
+            memmove(data + 1, data, count * sizeof(int));
+            data[0] = (int)j;
+            count++;
+        }
+        bench_sink += count;
+        free(data);
+    }
+    return bench_now() - start;
+}
+
+// Removing from the front until the array is empty; filling it is timed too
+
+static double bench_remove_eass(size_t size, size_t iterations) {
+    double start = bench_now();
+    for (size_t i = 0; i < iterations; i++) {
+        DynamicArray arr = array(size);
+        for (size_t j = 0; j < size; j++) {
+            array_append(&arr, numlit((int)j));
+        }
+        while (arr.size > 0) {
+            DynamicValue val = array_remove(&arr, 0);
+            bench_sink += (size_t)val.value.i;
+        }
+        free_dynamic_array(&arr);
+    }
+    return bench_now() - start;
+}
+
+static double bench_remove_libc(size_t size, size_t iterations) {
+    double start = bench_now();
+    for (size_t i = 0; i < iterations; i++) {
+        int* data = (int*)malloc(size * sizeof(int));
+        size_t count = 0;
+        for (size_t j = 0; j < size; j++) {
+            data[count++] = (int)j;
+        }
+        while (count > 0) {
+            bench_sink += (size_t)data[0];
+            memmove(data, data + 1, --count * sizeof(int));
+        }
+        free(data);
+    }
+    return bench_now() - start;
+}
+
+// Writing and reading back whole files
+
+static double bench_write_file_eass(size_t size, size_t iterations) {
+    char saved = bench_text[size];
+    bench_text[size] = '\0';
+    double start = bench_now();
+    for (size_t i = 0; i < iterations; i++) {
+        write_file(bench_tmp_path, bench_text);
+    }
+    double elapsed = bench_now() - start;
+    bench_text[size] = saved;
+    return elapsed;
+}
+
+static double bench_write_file_libc(size_t size, size_t iterations) {
+    double start = bench_now();
+    for (size_t i = 0; i < iterations; i++) {
+        FILE* file = fopen(bench_tmp_path, "wb");
+        fwrite(bench_text, 1, size, file);
+        fclose(file);
+    }
+    return bench_now() - start;
+}
+
+static double bench_read_file_eass(size_t size, size_t iterations) {
+    bench_write_file_libc(size, 1);
+    double start = bench_now();
+    for (size_t i = 0; i < iterations; i++) {
+        char* content = read_file(bench_tmp_path);
+        bench_sink += content[0];
+        free(content);
+    }
+    return bench_now() - start;
+}
+
+static double bench_read_file_libc(size_t size, size_t iterations) {
+    bench_write_file_libc(size, 1);
+    double start = bench_now();
+    for (size_t i = 0; i < iterations; i++) {
+        FILE* file = fopen(bench_tmp_path, "rb");
+        char* content = (char*)malloc(size + 1);
+        bench_sink += fread(content, 1, size, file);
+        content[size] = '\0';
+        fclose(file);
+        free(content);
+    }
+    return bench_now() - start;
+}
+
+// Function to run the console benchmarks with standard output sent to the null device
+static void bench_console(const size_t* sizes, size_t count) {
+    fflush(stdout);
+    eass_flush();
+    int saved = dup(1);
+    FILE* null_device = fopen(BENCH_NULL_DEVICE, "w");
+    if (saved < 0 || !null_device) {
+        fprintf(stderr, "eass_bench: cannot redirect output, skipping print benchmarks\n");
+        return;
+    }
+    dup2(fileno(null_device), 1);
+    for (size_t i = 0; i < count; i++) {
+        bench_run("print_devnull", "eass", bench_print_eass, sizes[i], 1);
+        bench_run("print_devnull", "libc", bench_print_libc, sizes[i], 1);
+    }
+    fflush(stdout);
+    dup2(saved, 1);
+    close(saved);
+    fclose(null_device);
+}
+
+static void bench_write_json(void) {
+    printf("{\n  \"library\": \"eass.h\",\n  \"version\": \"%s\",\n", EASS_VERSION);
+#ifdef __VERSION__
+    printf("  \"compiler\": \"%s\",\n", __VERSION__);
+#endif
+    printf("  \"results\": [\n");
+    for (size_t i = 0; i < bench_result_count; i++) {
+        const BenchResult* r = &bench_results[i];
+        printf("    {\"benchmark\": \"%s\", \"impl\": \"%s\", \"size\": %zu, \"iterations\": %zu, \"ns_per_op\": %.2f}%s\n",
+               r->name, r->impl, r->size, r->iterations, r->ns_per_op, i + 1 < bench_result_count ? "," : "");
+    }
+    printf("  ]\n}\n");
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quick") == 0) {
+            bench_min_time = 0.02;
+        } else if (strcmp(argv[i], "--tmp") == 0 && i + 1 < argc) {
+            bench_tmp_path = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--quick] [--tmp <scratch file>]\n", argv[0]);
+            return 2;
+        }
+    }
+    for (size_t i = 0; i < sizeof(bench_text); i++) {
+        bench_text[i] = (char)('a' + i % 26);
+    }
+
+    static const size_t string_sizes[] = {8, 64, 1024};
+    static const size_t array_sizes[] = {16, 1024, 65536};
+    static const size_t shift_sizes[] = {16, 256, 4096};
+    static const size_t file_sizes[] = {4096, 65536, 1 << 20};
+    size_t count = sizeof(string_sizes) / sizeof(string_sizes[0]);
+
+    bench_console(string_sizes, count);
+    for (size_t i = 0; i < count; i++) {
+        bench_run("print_memory", "eass", bench_print_memory_eass, string_sizes[i], 1);
+        bench_run("print_memory", "libc", bench_print_memory_libc, string_sizes[i], 1);
+        bench_run("string_format", "eass", bench_string_format_eass, string_sizes[i], 1);
+        bench_run("string_format", "libc", bench_string_format_libc, string_sizes[i], 1);
+    }
+    for (size_t i = 0; i < count; i++) {
+        bench_run("array_append", "eass", bench_append_eass, array_sizes[i], array_sizes[i]);
+        bench_run("array_append", "libc", bench_append_libc, array_sizes[i], array_sizes[i]);
+        bench_run("array_insert_front", "eass", bench_insert_eass, shift_sizes[i], shift_sizes[i]);
+        bench_run("array_insert_front", "libc", bench_insert_libc, shift_sizes[i], shift_sizes[i]);
+        bench_run("array_remove_front", "eass", bench_remove_eass, shift_sizes[i], shift_sizes[i]);
+        bench_run("array_remove_front", "libc", bench_remove_libc, shift_sizes[i], shift_sizes[i]);
+    }
+    for (size_t i = 0; i < count; i++) {
+        bench_run("write_file", "eass", bench_write_file_eass, file_sizes[i], 1);
+        bench_run("write_file", "libc", bench_write_file_libc, file_sizes[i], 1);
+        bench_run("read_file", "eass", bench_read_file_eass, file_sizes[i], 1);
+        bench_run("read_file", "libc", bench_read_file_libc, file_sizes[i], 1);
+    }
+    remove(bench_tmp_path);
+
+    bench_write_json();
+    return 0;
+}
@@ -40,6 +40,13 @@
  * -   Enhanced string formatting: Supports more format specifiers and dynamic width/precision
  * -   Array manipulation: Added functions for inserting, removing, and accessing array elements
  * -   Memory debugging: Optional memory leak detection for development
+ * -   Buffered output: print() collects each line in a per-thread buffer and writes it in one call
+ * -   Compiled format templates: print() and string_format() parse each template once and cache it
+ * -   Fast number output: integers and floats are converted without printf() and without locale effects
+ * -   Output targets: print_to(), print_fd(), print_buf() and print_sink() write to files, sockets and memory
+ * -   Asynchronous output: an optional background thread takes the I/O of print() off the calling thread
+ * -   Typed printing: print_typed() and string_format_typed() accept plain C values directly
+ * -   Binary logging: print_binlog() records values to a file and formats them later
  *
  * @section usage_sec Usage
  *
@@ -69,7 +76,7 @@
  * char *name = "John Doe";
  *
  * print("Name: {} Age: {} Salary: {}", name, age, salary);
- * // Output: Name: John Doe Age: 30 Salary: 50000.50
+ * // Output: Name: John Doe Age: 30 Salary: 50000.5
  *
  * return 0;
  * }
@@ -86,7 +93,7 @@
  * } else if (user_input.type == EASS_STRING && user_input.error) {
  * print("Invalid input. Please enter a number.");
  * } else {
- * print("Your input is: {}", user_input.value.s);
+ * print("Your input is: {}", string_value(&user_input));
  * }
  *
  * return 0;
@@ -180,6 +187,69 @@
  * The caller is responsible for freeing this memory using the
  * `free_dynamic_value()` function when the DynamicValue is no longer needed.
  *
+ * @subsection short_strings Short Strings
+ *
+ * A string of at most `EASS_SSO_SIZE` (16) bytes including its terminator is kept inside
+ * the DynamicValue itself, in the space the embedded DynamicArray occupies, and marked with
+ * `EASS_FLAG_INLINE` in its `flags`. `input()` returns short answers this way, and
+ * `strlit()` / `strlit_n()` build string values that take the inline form when they fit
+ * and copy to the heap otherwise. Storing such values in an array costs no allocation.
+ *
+ * Because the text may live in either place, read it with `string_value(&val)` rather than
+ * `val.value.s`. `free_dynamic_value()`, `print()`, `string_format()` and the binary log
+ * handle both forms. Strings built by hand with `.value.s = malloc(...)` remain valid.
+ *
+ * @subsection compact_values Compact Values
+ *
+ * A DynamicValue normally embeds a whole DynamicArray and takes 40 bytes on 64-bit targets.
+ * Defining `EASS_COMPACT_VALUES` before including eass.h switches to a 16-byte layout: the type,
+ * error and flags become bytes, an array is held through a heap `DynamicArray*` that the value
+ * owns, a view keeps its length (at most 4 GiB) beside the union, and inline strings shrink to
+ * `EASS_SSO_SIZE` 8 bytes. Arrays, `print()` arguments and `va_arg` copies all get smaller.
+ *
+ * Code that should build in both layouts wraps arrays with `array_value(arr)` instead of
+ * `(DynamicValue){EASS_ARRAY, 0, .value.a = arr}` and reads them with `EASS_ARRAY_OF(val)`, which
+ * gives a `DynamicArray*`; views are read with `EASS_VIEW_DATA(val)` and `EASS_VIEW_LENGTH(val)`.
+ *
+ * ```c
+ * DynamicValue list = array_value(array(8));
+ * *EASS_ARRAY_OF(list) = array_append(EASS_ARRAY_OF(list), numlit(1));
+ * print("{} has {} element(s)", list, numlit((int)EASS_ARRAY_OF(list)->size)); // Frees list
+ * ```
+ *
+ * @subsection string_views String Views
+ *
+ * `strview(data, length)` makes an `EASS_STRVIEW` value that points at text owned by someone
+ * else, such as a slice of a `read_file()` buffer. Nothing is copied, the text need not be
+ * NUL-terminated, and `free_dynamic_value()` / `free_dynamic_array()` leave it alone, so the
+ * buffer must outlive every view of it. Views print and format like strings; `string_value()`
+ * returns NULL for them, read `EASS_VIEW_DATA(val)` and `EASS_VIEW_LENGTH(val)` instead.
+ *
+ * ```c
+ * char* text = read_file("hosts.txt");
+ * DynamicArray lines = array(64);
+ * for (char* line = text; *line; ) {
+ *     size_t length = strcspn(line, "\n");
+ *     lines = array_append(&lines, strview(line, length));
+ *     line += length + (line[length] == '\n');
+ * }
+ * print("{}", array_value(lines)); // Frees the array, not the text
+ * free(text);
+ * ```
+ *
+ * @subsection string_interning String Interning
+ *
+ * `eass_intern(text)` returns a pooled copy of text that stays valid until
+ * `eass_intern_clear()`; equal text always gives the same pointer, so interned strings compare
+ * with `==`. The copies are packed into `EASS_INTERN_BLOCK_SIZE` byte blocks instead of one
+ * `malloc` each, and the pool is shared by all threads. `strintern(text)` makes a string value
+ * backed by the pool and `intern_value(val)` moves a string or view into it, so
+ * `array_append(&arr, intern_value(input("> ")))` interns on insert. Such values carry
+ * `EASS_FLAG_INTERNED` and are never freed individually. An `array_packed(EASS_STORAGE_INTERNED, n)`
+ * array keeps one pool pointer per element and interns every string or view added to it, so
+ * repeated text is stored once; like other interned strings its elements are invalid after
+ * `eass_intern_clear()`.
+ *
  * The `array()` and `array_append()` functions allocate memory for the array
  * and its elements using `malloc()` and `realloc()`. The caller is responsible
  * for freeing the memory using `free_dynamic_array()`.
@@ -212,13 +282,37 @@
  *
  * ```c
  * typedef struct {
- * DynamicValue* data;    // Pointer to the array data
+ * union { DynamicValue* data; int* ints; float* floats; char** strings; }; // Pointer to the array data
  * size_t size;        // Current size of the array
  * size_t capacity;    // Current capacity of the array
  * int error;           // Non-zero if an error occurred
+ * unsigned char storage; // EassStorage: how the elements are laid out
  * } DynamicArray;
  * ```
  *
+ * @subsection packed_arrays Packed Arrays
+ *
+ * `array_packed(storage, initial_capacity)` creates an array that keeps its elements without a
+ * DynamicValue around each one: `EASS_STORAGE_INT` (4 bytes per element, in `ints`),
+ * `EASS_STORAGE_FLOAT` (in `floats`), `EASS_STORAGE_STRING` (owned heap strings, in `strings`;
+ * short inline and interned strings are copied to the heap) or `EASS_STORAGE_INTERNED` (pointers
+ * into the intern pool, in `strings`; see String Interning). `array_append()`,
+ * `array_insert()`, `array_get()`, `array_remove()`, `print()` and the free functions work on them
+ * unchanged. Adding a value of another type or an error value switches the array to ordinary
+ * `EASS_STORAGE_VALUES` elements first; `array_unpack()` does that on demand. Only arrays with
+ * `EASS_STORAGE_VALUES` storage may be read through `data`.
+ *
+ * ```c
+ * DynamicArray ids = array_packed(EASS_STORAGE_INT, 1024);
+ * for (int i = 0; i < 1000; i++) {
+ *     ids = array_append(&ids, numlit(i)); // Stored as a plain int
+ * }
+ * long sum = 0;
+ * for (size_t i = 0; i < ids.size; i++) {
+ *     sum += ids.ints[i];
+ * }
+ * ```
+ *
  * @section string_formatting String Formatting
  *
  * The `string_format()` function provides basic string formatting capabilities, similar to Python's `format()` method.
@@ -232,6 +326,190 @@
  * }
  * ```
  *
+ * `{N}` placeholders pick an argument by index, so localized templates can reorder and repeat
+ * them: `string_format("{1}, {0}! {1}?", numlit(1), name)`. A call passes as many arguments as the
+ * template has `{}` slots or as its highest index needs, whichever is more; each argument is read
+ * once and freed once however often it is used. `print()` and its variants accept indices too.
+ *
+ * `string_format()` first measures the exact length of the result, nested arrays included, and
+ * then allocates it once, so the string is never truncated and has no unused space.
+ *
+ * Two variants avoid the heap entirely (as long as there are at most `EASS_FORMAT_STACK_ARGS`
+ * arguments). `string_format_into()` writes into a caller buffer and, like `snprintf()`, returns
+ * the full length so a too-small buffer can be detected. `string_format_arena()` carves strings
+ * out of caller memory that is released all at once with `eass_arena_reset()`.
+ *
+ * ```c
+ * char line[64];
+ * if (string_format_into(line, sizeof(line), "user {}", numlit(id)) >= (int)sizeof(line)) {
+ *     // Truncated
+ * }
+ *
+ * char memory[4096];
+ * EassArena arena = eass_arena(memory, sizeof(memory));
+ * char* key = string_format_arena(&arena, "session:{}", numlit(id)); // NULL if the arena is full
+ * eass_arena_reset(&arena); // At the end of the request
+ * ```
+ *
+ * @subsection number_formatting Number Formatting
+ *
+ * Integers and floats are converted to text by the library itself rather than by `printf()`, so
+ * the output never depends on the current locale. Floats are printed with the fewest digits that
+ * read back as exactly the same value, in the style of Python's `repr()`:
+ * `0.1`, `2.5`, `100.0`, `0.0001`, `1e-05`, `1.5e+20`, `nan`, `-inf`.
+ *
+ * @subsection format_specs Format Specifications
+ *
+ * A placeholder can carry a Python-style specification after a colon:
+ * `{[index]:[[fill]align][sign][#][0][width][.precision][type]}`.
+ *
+ * ```c
+ * print("{:08.3f}", numlit(3.14159f));  // 0003.142
+ * print("{:x} {:#X} {:b}", numlit(255), numlit(255), numlit(5)); // ff 0XFF 101
+ * print("[{:>8}] [{:<8}] [{:*^8}]", numlit(1), numlit(2), numlit(3)); // [       1] [2       ] [***3****]
+ * print("{:+d} {:.1%} {:.2e}", numlit(5), numlit(0.256f), numlit(12345.0f)); // +5 25.6% 1.23e+04
+ * print("{:.3}", name);          // Precision on text keeps at most 3 characters
+ * ```
+ *
+ * Align is `<` (default for text), `>` (default for numbers), `^` or `=` (pad after the sign), and
+ * a leading `0` means fill `0` with `=`. Types are `d`, `x`, `X`, `o`, `b` and `c` for integers and
+ * `f`, `F`, `e`, `E`, `g`, `G` and `%` for integers and floats; a float with precision and no type
+ * uses `g`. Types that do not apply to a value are ignored, arrays and `NULL` are padded as text,
+ * and a placeholder with an invalid specification is copied as text.
+ *
+ * Specifications are parsed once into the compiled template. Integers, padding and `f` with up to
+ * 19 decimals are written by the library itself (rounded like `printf()`); `e`, `g` and very large
+ * or very precise `f` values fall back to `snprintf()`.
+ *
+ * @subsection compiled_formats Compiled Format Templates
+ *
+ * `print()` and `string_format()` turn each template into a list of literal spans and argument
+ * slots the first time they see it and keep that list in a per-thread cache of
+ * `EASS_FORMAT_CACHE_SIZE` entries keyed by the address of the format string. Repeated calls from
+ * a loop only copy the literal spans and fill in the slots.
+ *
+ * A cache hit compares the cached text with the format string, so a buffer that is reused with new
+ * text gets a new template. Programs whose format strings never change in place (string literals,
+ * for example) can define `EASS_FORMAT_CACHE_TRUST_POINTERS` to take a known address as a hit
+ * without comparing the text. A thread's cache is freed when the thread exits (C11 threads only);
+ * `eass_format_cache_clear()` frees it earlier.
+ *
+ * Literal text is skipped 32 bytes at a time with AVX2 or 16 bytes at a time with SSE2 when the
+ * compiler targets them; define `EASS_NO_SIMD` to force the plain C scanner.
+ *
+ * Templates can also be compiled explicitly:
+ * ```c
+ * EassFormat* line = eass_format_compile("x = {}, y = {}");
+ * for (int i = 0; i < 10; i++) {
+ * print_compiled(line, numlit(i), numlit(i * i));
+ * }
+ * eass_format_free(line);
+ * ```
+ *
+ * @subsection string_builder String Builder
+ *
+ * Building a string by calling `string_format()` in a loop copies the whole prefix every time.
+ * An `EassStr` grows geometrically instead, and keeps up to `EASS_STR_INLINE_SIZE - 1`
+ * characters inside the struct without allocating. `string_format()`, `string_format_typed()`,
+ * `input()` and the asynchronous `print()` build their text with it.
+ *
+ * ```c
+ * EassStr csv = eass_str();
+ * for (int i = 0; i < n; i++) {
+ *     eass_str_append_int(&csv, ids[i]);
+ *     eass_str_append(&csv, ",", 1);
+ *     eass_str_append_value(&csv, &names[i]); // Borrowed
+ *     eass_str_appendf(&csv, ",{}\n", numlit(scores[i])); // Frees its arguments like string_format()
+ * }
+ * write_file("out.csv", eass_str_cstr(&csv));
+ * eass_str_free(&csv); // Or char* s = eass_str_release(&csv) to keep the text
+ * ```
+ *
+ * @section typed_arguments Printing Plain C Values
+ *
+ * `print()` and `string_format()` read every argument as a `DynamicValue` and free it afterwards.
+ * The `print_typed()` and `string_format_typed()` macros instead accept plain C values (integers,
+ * `float`, `double`, `char*`, `DynamicValue` and `DynamicValue*`, up to 16 of them). `_Generic`
+ * packs each one into a small `EassArg` on the stack, so nothing is wrapped, copied or freed.
+ * Positional placeholders read straight from that array, so `{0}` can be used any number of times.
+ *
+ * ```c
+ * const char* name = "John Doe";
+ * DynamicValue scores = ...;
+ * print_typed("{} is {} years old, salary {}, scores {}", name, 30, 50000.5, &scores);
+ * char* s = string_format_typed("{0}-{1}-{0}", "a", 2); // "a-2-a"
+ * ```
+ *
+ * Doubles are printed with the fewest digits that read back exactly, like floats, but through a
+ * slower `snprintf()`-based search.
+ *
+ * @section output_targets Output Targets
+ *
+ * `print()` writes to standard output. The same formatting can be sent anywhere else without
+ * building an intermediate string first:
+ *
+ * -   `print_to(FILE* file, format, ...)`: Write one line to a stdio stream.
+ * -   `print_fd(int fd, format, ...)`: Write one line to a file descriptor with a single `write(2)`.
+ * -   `print_buf(char* buf, size_t capacity, format, ...)`: Write into a caller buffer. Like `snprintf()`,
+ * it always terminates the text and returns the length the full line would have had.
+ * -   `print_sink(EassSink* sink, format, ...)`: Write to a sink made by `eass_sink_file()`, `eass_sink_fd()`,
+ * `eass_sink_buffer()` or `eass_sink_memory()`. A memory sink collects every line in `sink.data`
+ * (`sink.size` bytes) until `eass_sink_free()` is called.
+ *
+ * These functions take ownership of their arguments exactly like `print()`.
+ *
+ * ```c
+ * EassSink log = eass_sink_memory();
+ * print_sink(&log, "request {} took {} ms", numlit(42), numlit(3.5));
+ * print_sink(&log, "request {} took {} ms", numlit(43), numlit(1.25));
+ * write_file("requests.log", log.data);
+ * eass_sink_free(&log);
+ * ```
+ *
+ * @section async_printing Asynchronous print()
+ *
+ * `eass_async_start(capacity, policy)` moves the terminal and disk I/O of `print()` and
+ * `print_compiled()` to a background thread. The calling thread still formats the line, copies
+ * it into a lock-free queue of `capacity` slots of `EASS_ASYNC_SLOT_SIZE` bytes and returns.
+ * The queue never grows, so its memory is bounded.
+ *
+ * -   `EASS_ASYNC_BLOCK`: When the queue is full, `print()` sleeps until the background thread has made room.
+ * -   `EASS_ASYNC_DROP`: When the queue is full, the line is discarded and counted by `eass_async_dropped()`.
+ *
+ * `eass_async_stop()` writes out everything still queued and returns to synchronous output. It
+ * runs automatically at exit. Async mode needs C11 threads and atomics (`EASS_HAS_ASYNC`).
+ * `printhd()` lines are queued as well, and `input()` waits until queued lines are written before
+ * showing its prompt. While the queue is empty the background thread sleeps until a line arrives.
+ *
+ * ```c
+ * eass_async_start(4096, EASS_ASYNC_BLOCK);
+ * print("worker {} done", numlit(id)); // Returns without waiting for the terminal
+ * eass_async_stop();
+ * ```
+ *
+ * @section binary_log Binary Logging
+ *
+ * For high-volume tracing, `print_binlog()` records a call instead of formatting it. Each record
+ * holds the id of its template, a timestamp and the raw argument values tagged with their
+ * `EassType`, and is appended to a buffer owned by the calling thread. Full buffers are written
+ * to the file given to `eass_binlog_open()`. Templates are written once per thread.
+ *
+ * ```c
+ * eass_binlog_open("trace.bin");
+ * print_binlog("request {} took {} ms", numlit(id), numlit(ms)); // Frees its arguments like print()
+ * print_binlog_typed("request {} took {} ms", id, ms);           // Plain C values, like print_typed()
+ * eass_binlog_close();
+ * ```
+ *
+ * The file is turned into text by `eass_binlog_decode()` or by the small tool in
+ * `tools/eass_binlog_decode.c`. Each line starts with the seconds since the log was opened.
+ * The file uses the byte order of the machine that wrote it.
+ *
+ * A thread's buffer is written out when it fills, when the thread calls `eass_binlog_flush()`
+ * and when the thread exits (C11 threads only). `eass_binlog_close()`, which is registered with
+ * `atexit()`, writes out every thread's buffer before closing the file. Records from different
+ * threads are grouped by buffer, so sort by timestamp to interleave them.
+ *
  * @section file_operations File Operations
  *
  * The `read_file()` and `write_file()` functions provide simplified file reading and writing capabilities.
@@ -272,6 +550,73 @@
  * -   `array_insert(DynamicArray* arr, size_t index, DynamicValue val)`: Inserts a value into the array at a given index.
  * -   `array_remove(DynamicArray* arr, size_t index)`: Removes the element at a given index from the array.
  * -   `array_get(const DynamicArray* arr, size_t index)`: Retrieves the element at a given index from the array.
+ * -   `array_insert_range(DynamicArray* arr, size_t index, const DynamicValue* values, size_t count)`: Inserts
+ * `count` values at `index`, taking ownership of them.
+ * -   `array_remove_range(DynamicArray* arr, size_t index, size_t count)`: Frees `count` elements starting at `index`.
+ *
+ * Both move the tail of the array once with `memmove`, so editing N elements in the middle costs one O(n) shift.
+ *
+ * -   `array_reserve(DynamicArray* arr, size_t capacity)`: Allocates room for `capacity` elements up front.
+ * -   `array_extend(DynamicArray* arr, const DynamicValue* values, size_t count)`: Appends `count` values,
+ * taking ownership of them, with at most one reallocation. If it fails, the values still belong to the caller.
+ * -   `array_extend_array(DynamicArray* arr, DynamicArray* src)`: Moves every element of `src` to the end of `arr`,
+ * with a single `memcpy` when both use the same storage; `src` is left empty.
+ * -   `array_resize(DynamicArray* arr, size_t size)`: Frees elements past `size`, or adds NULL values up to it.
+ * -   `array_shrink_to_fit(DynamicArray* arr)`: Gives back the capacity the array does not use.
+ *
+ * These work in place and return 0 on success or -1 on error. `array_append()` grows the capacity by 1.5x.
+ * -   `array_join(const DynamicArray* arr, const char* sep)`: Returns a new string with the elements, written as
+ * `print()` shows them, separated by `sep`. The length is measured first so the result is allocated once.
+ * Free it with `free()`.
+ *
+ * @subsection reductions Reductions
+ *
+ * `array_sum()`, `array_mean()`, `array_min()`, `array_max()`, `array_argmin()` and `array_argmax()`
+ * return their result as a DynamicValue: sums of ints are an `EASS_INT` (an error if they overflow),
+ * means and anything involving floats an `EASS_FLOAT`, and the arg functions the index of the first
+ * match. Packed int and float arrays are reduced with SSE2 or AVX2 when available, 4 or 8 elements
+ * at a time; ordinary arrays may mix ints and floats and are reduced element by element. The
+ * min/max functions skip NaN unless every element is NaN, and return the first of equal zeros.
+ * Strings, arrays and NULL make the result an error value, as does an empty array for everything
+ * except `array_sum()`.
+ *
+ * @subsection sorting Sorting
+ *
+ * `array_sort()` sorts an array in place in the order of `value_compare()`: NULL values, NULL
+ * strings (such as the empty slots `array_resize()` leaves in a packed string array) and error
+ * values first, then ints and floats compared by value with NaN last, then strings and views byte
+ * by byte, then arrays element by element. Packed int and float arrays, and arrays that hold only
+ * ints or only floats, are sorted with an LSD radix sort; everything else with introsort. Neither
+ * is stable. `array_sort_by(arr, compare, ctx)` takes an `EassCompare` function instead, and
+ * `array_sort_parallel(arr, threads)` sorts large arrays in `threads` pieces at once and merges
+ * them.
+ *
+ * ```c
+ * static int by_length(const DynamicValue* a, const DynamicValue* b, void* ctx) {
+ *     return (int)strlen(string_value(a)) - (int)strlen(string_value(b));
+ * }
+ *
+ * array_sort(&scores);
+ * array_sort_by(&names, by_length, NULL);
+ * ```
+ *
+ * @subsection deque_sec Double-ended Queues
+ *
+ * Using `array_insert(arr, 0, v)` and `array_remove(arr, 0)` as a queue costs O(n) per operation. A
+ * `DynamicDeque` keeps its elements in a power-of-two ring buffer instead, so `deque_push_back()`,
+ * `deque_push_front()`, `deque_pop_back()` and `deque_pop_front()` are O(1). `deque_get(dq, i)` reads
+ * the i-th element from the front with the same checks as `array_get()`. Popped values belong to
+ * the caller; `free_dynamic_deque()` frees the rest.
+ *
+ * ```c
+ * DynamicDeque jobs = deque(64);
+ * deque_push_back(&jobs, strlit("resize"));
+ * deque_push_front(&jobs, strlit("urgent"));
+ * while (jobs.size > 0) {
+ *     print("{}", deque_pop_front(&jobs)); // Frees the value
+ * }
+ * free_dynamic_deque(&jobs);
+ * ```
  *
  * @section memory_debugging Memory Debugging
  *
@@ -288,6 +633,27 @@
  * **Important:** The `EASS_DEBUG_MEMORY` macro should only be used during development,
  * as it adds overhead to the program.
  *
+ * @section output_buffering Output Buffering
+ *
+ * `print()` and `printhd()` do not call stdio for every character. Each thread collects its
+ * output in a buffer of `EASS_OUTPUT_BUFFER_SIZE` bytes (4096 by default) which is handed to
+ * `write(2)` in a single call (`fwrite()` on Windows and embedded systems).
+ *
+ * -   `eass_set_flush_policy(EASS_FLUSH_LINE)`: Write after every `print()` call (default).
+ * -   `eass_set_flush_policy(EASS_FLUSH_FULL)`: Write only when the buffer is full, batching many lines.
+ * -   `eass_flush()`: Write whatever the calling thread has buffered right now.
+ *
+ * The main thread's buffer is flushed automatically at exit. Other threads using `EASS_FLUSH_FULL`
+ * should call `eass_flush()` before they finish.
+ *
+ * @section benchmarks Benchmarks
+ *
+ * `bench/eass_bench.c` times `print()`, `string_format()`, the array functions, `read_file()` and
+ * `write_file()` at several sizes next to the equivalent libc code, and prints the results as
+ * JSON (`benchmark`, `impl`, `size`, `iterations`, `ns_per_op`) along with `EASS_VERSION`.
+ * Run it with `--quick` for a short pass. `tests/eass_check.c` runs regression checks for format
+ * specs, sorting, reductions, deques and packed arrays; its exit status is the number of failures.
+ *
  * @section license License
  *
  * This library is distributed under the MIT License with some modifications.
@@ -323,6 +689,8 @@
 #ifndef EASS_H
 #define EASS_H
 
+#define EASS_VERSION "1.1 alpha" // Keep in sync with @version above
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -330,9 +698,13 @@
 #include <errno.h>
 #include <time.h> // Required for time measurement
 #include <math.h> // Required for isnan()
+#include <float.h> // Required for DBL_MIN
+#include <limits.h> // Required for INT_MAX
+#include <stdint.h> // Required for uintptr_t
 
 #ifdef _WIN32
 #include <windows.h>
+#include <io.h> // Required for _write()
 #elif defined(__linux__) || defined(__APPLE__)
 #include <iconv.h>
 #include <unistd.h>
@@ -344,6 +716,43 @@
 // Enable C11 thread_local if available
 #if __STDC_VERSION__ >= 201112L
 #include <threads.h>
+#define EASS_THREAD_LOCAL thread_local
+#else
+#define EASS_THREAD_LOCAL
+#endif
+
+// C11 threads and atomics, used to free per-thread caches and buffers at thread exit, to share the
+// binary log and the intern pool between threads, and by array_sort_parallel()
+#if __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__) && !defined(__STDC_NO_ATOMICS__)
+#include <stdatomic.h>
+#define EASS_HAS_THREADS 1
+#endif
+
+// Asynchronous print() also needs a background thread, which embedded builds do without
+#if defined(EASS_HAS_THREADS) && !defined(EASS_ENABLE_EMBEDDED)
+#define EASS_HAS_ASYNC 1
+#endif
+
+// Vector instructions used to scan format strings and reduce packed arrays. Define EASS_NO_SIMD to
+// use plain C only.
+#if !defined(EASS_NO_SIMD) && defined(__AVX2__)
+#include <immintrin.h>
+#define EASS_USE_AVX2 1
+#elif !defined(EASS_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define EASS_USE_SSE2 1
+#endif
+
+// The vector scanners read whole aligned blocks, which AddressSanitizer would report
+#if defined(__SANITIZE_ADDRESS__)
+#define EASS_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define EASS_NO_SANITIZE_ADDRESS __attribute__((no_sanitize_address))
+#endif
+#endif
+#ifndef EASS_NO_SANITIZE_ADDRESS
+#define EASS_NO_SANITIZE_ADDRESS
 #endif
 
 // Check for iconv availability
@@ -357,6 +766,61 @@
 // Default input buffer size
 #define EASS_INPUT_BUFFER_SIZE 256
 
+// Size of the per-thread buffer that collects print() output before it is written
+#ifndef EASS_OUTPUT_BUFFER_SIZE
+#define EASS_OUTPUT_BUFFER_SIZE 4096
+#endif
+
+// Number of compiled format templates cached per thread by print() and string_format()
+#ifndef EASS_FORMAT_CACHE_SIZE
+#define EASS_FORMAT_CACHE_SIZE 64
+#endif
+
+// Bytes per slot of the asynchronous print() queue; longer lines use several slots
+#ifndef EASS_ASYNC_SLOT_SIZE
+#define EASS_ASYNC_SLOT_SIZE 256
+#endif
+
+// Stack space used to collect one line for print_to() and print_fd()
+#ifndef EASS_SINK_STAGE_SIZE
+#define EASS_SINK_STAGE_SIZE 512
+#endif
+
+// Bytes of text (with terminator) a string DynamicValue holds without allocating; must fit in
+// the space of the embedded DynamicArray, or of a pointer with EASS_COMPACT_VALUES
+#ifndef EASS_SSO_SIZE
+#ifdef EASS_COMPACT_VALUES
+#define EASS_SSO_SIZE 8
+#else
+#define EASS_SSO_SIZE 16
+#endif
+#endif
+
+// Bytes of text (with terminator) an EassStr holds without allocating
+#ifndef EASS_STR_INLINE_SIZE
+#define EASS_STR_INLINE_SIZE 32
+#endif
+
+// Largest width or precision a format specification can ask for
+#ifndef EASS_FORMAT_MAX_WIDTH
+#define EASS_FORMAT_MAX_WIDTH 4096
+#endif
+
+// Number of string_format() arguments kept on the stack; more than this use the heap
+#ifndef EASS_FORMAT_STACK_ARGS
+#define EASS_FORMAT_STACK_ARGS 16
+#endif
+
+// Size of each thread's binary log buffer
+#ifndef EASS_BINLOG_BUFFER_SIZE
+#define EASS_BINLOG_BUFFER_SIZE 65536
+#endif
+
+// Bytes per block of the arena that holds interned strings
+#ifndef EASS_INTERN_BLOCK_SIZE
+#define EASS_INTERN_BLOCK_SIZE 65536
+#endif
+
 // Forward declaration
 typedef struct DynamicValue DynamicValue;
 typedef struct DynamicArray DynamicArray;
@@ -396,36 +860,247 @@ typedef enum {
     EASS_FLOAT,
     EASS_STRING,
     EASS_ARRAY,
-    EASS_NULL
+    EASS_NULL,
+    EASS_STRVIEW // Borrowed text of a given length; never freed by the library
 } EassType;
 
+// Bits of DynamicValue.flags
+#define EASS_FLAG_INLINE 0x01   // An EASS_STRING stored in value.sso rather than on the heap
+#define EASS_FLAG_INTERNED 0x02 // An EASS_STRING owned by the intern pool, see eass_intern()
+
+// How a DynamicArray lays out its elements
+typedef enum {
+    EASS_STORAGE_VALUES, // DynamicValue elements of any type, in data
+    EASS_STORAGE_INT,    // Packed int elements, in ints
+    EASS_STORAGE_FLOAT,   // Packed float elements, in floats
+    EASS_STORAGE_STRING,  // Packed heap strings owned by the array, in strings
+    EASS_STORAGE_INTERNED // Packed pointers into the intern pool, in strings; never freed by the array
+} EassStorage;
+
+// Structure for dynamic array
+struct DynamicArray {
+    union {
+        DynamicValue* data; // Pointer to the array data
+        int* ints;
+        float* floats;
+        char** strings;
+    };
+    size_t size;        // Current size of the array
+    size_t capacity;    // Current capacity of the array
+    int error;           // Non-zero if an error occurred
+    unsigned char storage; // EassStorage; only EASS_STORAGE_VALUES arrays may be read through data
+};
+
+#ifdef EASS_COMPACT_VALUES
+// 16-byte dynamic value: arrays are held by pointer and a view keeps its length beside the union
+struct DynamicValue {
+    unsigned char type;  // EassType
+    unsigned char error; // 1 if there is an error
+    unsigned char flags; // EASS_FLAG_* bits describing how the value is stored
+    uint32_t length;     // Length of an EASS_STRVIEW
+    union {
+        int i;
+        float f;
+        char* s;                 // Heap string; use string_value() to read any string
+        char sso[EASS_SSO_SIZE]; // Short string kept in place, with EASS_FLAG_INLINE
+        const char* sv;          // EASS_STRVIEW text, not necessarily NUL-terminated
+        DynamicArray* a;         // Heap DynamicArray owned by the value; make it with array_value()
+    } value;
+};
+
+// Accessors that work with either DynamicValue layout
+#define EASS_ARRAY_OF(v) ((v).value.a)
+#define EASS_VIEW_DATA(v) ((v).value.sv)
+#define EASS_VIEW_LENGTH(v) ((size_t)(v).length)
+#else
 // Structure to store dynamic values
 struct DynamicValue {
     EassType type;
-    int error; // 1 if there is an error
+    unsigned char error; // 1 if there is an error
+    unsigned char flags; // EASS_FLAG_* bits describing how the value is stored
     union {
         int i;
         float f;
-        char* s;
+        char* s;                 // Heap string; use string_value() to read any string
+        char sso[EASS_SSO_SIZE]; // Short string kept in place, with EASS_FLAG_INLINE
+        struct {
+            const char* data; // Not necessarily NUL-terminated
+            size_t length;
+        } sv;                    // EASS_STRVIEW
         DynamicArray a;
     } value;
 };
 
-// Structure for dynamic array
-struct DynamicArray {
-    DynamicValue* data;    // Pointer to the array data
-    size_t size;        // Current size of the array
-    size_t capacity;    // Current capacity of the array
-    int error;           // Non-zero if an error occurred
-};
+// Accessors that work with either DynamicValue layout
+#define EASS_ARRAY_OF(v) (&(v).value.a)
+#define EASS_VIEW_DATA(v) ((v).value.sv.data)
+#define EASS_VIEW_LENGTH(v) ((v).value.sv.length)
+#endif
+
+// Double-ended queue of DynamicValues kept in a power-of-two ring buffer
+typedef struct {
+    DynamicValue* data;
+    size_t head;     // Slot of the first element
+    size_t size;     // Current number of elements
+    size_t capacity; // Zero or a power of two
+    int error;       // Non-zero if an error occurred
+} DynamicDeque;
+
+// Comparison used by array_sort_by(); returns a negative number, zero or a positive number when a
+// sorts before, together with or after b
+typedef int (*EassCompare)(const DynamicValue* a, const DynamicValue* b, void* ctx);
+
+// Kinds of operations in a compiled format template
+typedef enum {
+    EASS_OP_LITERAL,    // Copy a span of the template text
+    EASS_OP_NEXT_ARG,   // "{}": format the next argument
+    EASS_OP_INDEXED_ARG // "{N}": format the argument with index N
+} EassFormatOpKind;
+
+// Presentation options of a placeholder such as "{:08.3f}", "{:x}" or "{:>12}"
+typedef struct {
+    char fill;      // Padding character, ' ' by default
+    char align;     // '<', '>', '^' or '=' (padding after the sign), 0 for the default of the value
+    char sign;      // '+', ' ' or '-' (the default, only negative numbers get a sign)
+    char type;      // 'd', 'x', 'X', 'o', 'b', 'c', 'f', 'F', 'e', 'E', 'g', 'G', '%', 's', or 0
+    int alternate;  // '#': 0x, 0o or 0b in front of integers
+    int width;      // Minimum width, 0 for none
+    int precision;  // Digits for floats, maximum length for text, -1 for none
+} EassFormatSpec;
+
+// One operation of a compiled format template
+typedef struct {
+    EassFormatOpKind kind;
+    size_t offset; // Start of the span in the template text
+    size_t length; // Length of the span in the template text
+    int index;     // Argument index for EASS_OP_INDEXED_ARG
+    int has_spec;  // Non-zero if the placeholder has a ":spec" part
+    EassFormatSpec spec;
+} EassFormatOp;
+
+// A format template compiled into a list of literal spans and argument slots
+typedef struct {
+    const char* text;  // Private copy of the template
+    size_t length;     // Length of the template text
+    EassFormatOp* ops; // Operations in output order
+    size_t op_count;
+    size_t next_args;  // Number of "{}" slots
+    int max_index;     // Highest "{N}" index, -1 if there is none
+    uint32_t binlog_id;         // Id of the template in the open binary log
+    unsigned binlog_generation; // Binary log that binlog_id belongs to, 0 if none
+} EassFormat;
+
+// Growable string that keeps short text inline. A zeroed EassStr is a valid empty string.
+typedef struct {
+    char* heap;      // Heap storage, NULL while the text fits in small
+    size_t size;     // Length of the text
+    size_t capacity; // Characters the heap storage holds, not counting the terminator
+    int error;       // Non-zero if an allocation failed
+    char small[EASS_STR_INLINE_SIZE];
+} EassStr;
+
+// Kinds of destinations that formatted output can be written to
+typedef enum {
+    EASS_SINK_FILE,   // A stdio stream
+    EASS_SINK_FD,     // A raw file descriptor
+    EASS_SINK_BUFFER, // A caller-supplied buffer of fixed size
+    EASS_SINK_MEMORY, // A heap buffer that grows as needed
+    EASS_SINK_STRING  // An EassStr
+} EassSinkKind;
+
+// Destination for formatted output, shared by print() and string_format()
+typedef struct {
+    EassSinkKind kind;
+    FILE* file;      // Stream for EASS_SINK_FILE
+    int fd;          // Descriptor for EASS_SINK_FD
+    char* data;      // Pending bytes for files and descriptors, the output itself otherwise
+    size_t size;     // Number of bytes in data
+    size_t capacity; // Size of data
+    size_t total;    // Bytes produced, including any that did not fit into a EASS_SINK_BUFFER
+    int error;       // Non-zero if a write or an allocation failed
+    EassStr* str;    // Builder for EASS_SINK_STRING
+} EassSink;
+
+// When the buffered output of print() is handed to the operating system
+typedef enum {
+    EASS_FLUSH_LINE, // After every print() call, i.e. once per completed line (default)
+    EASS_FLUSH_FULL  // Only when the buffer is full or eass_flush() is called
+} EassFlushPolicy;
+
+// Caller memory that string_format_arena() allocates from, front to back
+typedef struct {
+    char* data;
+    size_t size;     // Bytes handed out
+    size_t capacity;
+} EassArena;
+
+// Kinds of arguments packed by print_typed() and string_format_typed()
+typedef enum {
+    EASS_ARG_INT,    // Any signed integer, or an unsigned one that fits in long long
+    EASS_ARG_UINT,   // unsigned long and unsigned long long
+    EASS_ARG_FLOAT,
+    EASS_ARG_DOUBLE,
+    EASS_ARG_STRING, // A borrowed C string
+    EASS_ARG_INLINE, // A short string copied from a DynamicValue passed by value
+    EASS_ARG_VIEW,   // A borrowed span of text
+    EASS_ARG_ARRAY,  // The borrowed elements of an EASS_ARRAY value
+    EASS_ARG_VALUE   // A borrowed DynamicValue
+} EassArgType;
+
+// Lightweight tagged reference to one argument of print_typed() and string_format_typed()
+typedef struct {
+    EassArgType type;
+    union {
+        long long i;
+        unsigned long long u;
+        float f;
+        double d;
+        const char* s;
+        const DynamicValue* v;
+        struct {
+            const void* data; // Laid out as storage says
+            size_t size;
+            unsigned char storage;
+        } a;
+        struct {
+            const char* data;
+            size_t length;
+        } sv;
+        char sso[EASS_SSO_SIZE];
+    } as;
+} EassArg;
+
+// What asynchronous print() does when its queue is full
+typedef enum {
+    EASS_ASYNC_BLOCK, // Wait until the background thread has made room
+    EASS_ASYNC_DROP   // Discard the line and count it in eass_async_dropped()
+} EassAsyncPolicy;
 
 // Function declarations
 DynamicValue input(const char* prompt);
 void print(const char* format, ...);
 void printhd(int number);
 DynamicValue numlit(double value);
+DynamicValue strlit(const char* text);
+DynamicValue strlit_n(const char* text, size_t len);
+const char* string_value(const DynamicValue* val);
+DynamicValue strview(const char* data, size_t length);
+const char* eass_intern(const char* text);
+const char* eass_intern_n(const char* text, size_t len);
+DynamicValue strintern(const char* text);
+DynamicValue intern_value(DynamicValue val);
+size_t eass_intern_count(void);
+void eass_intern_clear(void);
 DynamicArray array(size_t initial_capacity);
+DynamicArray array_packed(EassStorage storage, size_t initial_capacity);
+DynamicValue array_value(DynamicArray arr);
+int array_unpack(DynamicArray* arr);
 DynamicArray array_append(DynamicArray* arr, DynamicValue val);
+int array_reserve(DynamicArray* arr, size_t capacity);
+int array_extend(DynamicArray* arr, const DynamicValue* values, size_t count);
+int array_extend_array(DynamicArray* arr, DynamicArray* src);
+int array_resize(DynamicArray* arr, size_t size);
+int array_shrink_to_fit(DynamicArray* arr);
 void free_dynamic_array(DynamicArray* arr);
 void free_dynamic_value(DynamicValue* val);
 char* string_format(const char* format, ...);
@@ -434,7 +1109,73 @@ int write_file(const char* filename, const char* content);
 double get_time_in_seconds();
 DynamicArray array_insert(DynamicArray* arr, size_t index, DynamicValue val);
 DynamicValue array_remove(DynamicArray* arr, size_t index);
+int array_insert_range(DynamicArray* arr, size_t index, const DynamicValue* values, size_t count);
+int array_remove_range(DynamicArray* arr, size_t index, size_t count);
 DynamicValue array_get(const DynamicArray* arr, size_t index);
+char* array_join(const DynamicArray* arr, const char* sep);
+DynamicDeque deque(size_t initial_capacity);
+int deque_push_back(DynamicDeque* dq, DynamicValue val);
+int deque_push_front(DynamicDeque* dq, DynamicValue val);
+DynamicValue deque_pop_back(DynamicDeque* dq);
+DynamicValue deque_pop_front(DynamicDeque* dq);
+DynamicValue deque_get(const DynamicDeque* dq, size_t index);
+void free_dynamic_deque(DynamicDeque* dq);
+DynamicValue array_sum(const DynamicArray* arr);
+DynamicValue array_mean(const DynamicArray* arr);
+DynamicValue array_min(const DynamicArray* arr);
+DynamicValue array_max(const DynamicArray* arr);
+DynamicValue array_argmin(const DynamicArray* arr);
+DynamicValue array_argmax(const DynamicArray* arr);
+int value_compare(const DynamicValue* a, const DynamicValue* b);
+int array_sort(DynamicArray* arr);
+int array_sort_by(DynamicArray* arr, EassCompare compare, void* ctx);
+int array_sort_parallel(DynamicArray* arr, int threads);
+int eass_flush(void);
+void eass_set_flush_policy(EassFlushPolicy policy);
+EassFormat* eass_format_compile(const char* format);
+void eass_format_free(EassFormat* fmt);
+void eass_format_cache_clear(void);
+void print_compiled(const EassFormat* fmt, ...);
+char* string_format_compiled(const EassFormat* fmt, ...);
+EassSink eass_sink_file(FILE* file);
+EassSink eass_sink_fd(int fd);
+EassSink eass_sink_buffer(char* buf, size_t capacity);
+EassSink eass_sink_memory(void);
+EassSink eass_sink_str(EassStr* str);
+int eass_sink_flush(EassSink* sink);
+void eass_sink_free(EassSink* sink);
+void print_to(FILE* file, const char* format, ...);
+void print_fd(int fd, const char* format, ...);
+size_t print_buf(char* buf, size_t capacity, const char* format, ...);
+void print_sink(EassSink* sink, const char* format, ...);
+int eass_async_start(size_t capacity, EassAsyncPolicy policy);
+void eass_async_stop(void);
+size_t eass_async_dropped(void);
+void print_args(const char* format, const EassArg* args, size_t count);
+char* string_format_args(const char* format, const EassArg* args, size_t count);
+int string_format_into(char* buf, size_t capacity, const char* format, ...);
+EassArena eass_arena(void* buf, size_t capacity);
+void eass_arena_reset(EassArena* arena);
+char* string_format_arena(EassArena* arena, const char* format, ...);
+EassStr eass_str(void);
+const char* eass_str_cstr(const EassStr* str);
+int eass_str_reserve(EassStr* str, size_t extra);
+int eass_str_append(EassStr* str, const char* data, size_t len);
+int eass_str_append_cstr(EassStr* str, const char* text);
+int eass_str_append_int(EassStr* str, long long value);
+int eass_str_append_float(EassStr* str, float value);
+int eass_str_append_double(EassStr* str, double value);
+int eass_str_append_value(EassStr* str, const DynamicValue* val);
+int eass_str_appendf(EassStr* str, const char* format, ...);
+char* eass_str_release(EassStr* str);
+void eass_str_clear(EassStr* str);
+void eass_str_free(EassStr* str);
+int eass_binlog_open(const char* filename);
+int eass_binlog_flush(void);
+void eass_binlog_close(void);
+void print_binlog(const char* format, ...);
+void print_binlog_args(const char* format, const EassArg* args, size_t count);
+int eass_binlog_decode(FILE* in, FILE* out);
 
 // Macro for automatic resource management
 #define EASS_SCOPE(statement) \
@@ -443,135 +1184,3042 @@ DynamicValue array_get(const DynamicArray* arr, size_t index);
     }
 
 // Macro for defining numeric literals with automatic type detection
-#define numlit(x) _Generic((x),           \
-                           int          \
-                           ,            \
-                           float        \
-                           ,            \
-                           double       \
-                           :            \
-                           (DynamicValue) {EASS_FLOAT, 0, .value.f = (float)(x)}, \
-                           default      \
-                           :            \
-                           (DynamicValue) {EASS_INT, 0, .value.i = (int)(x)})
+#define numlit(x) _Generic((x),                                              \
+                           float: (DynamicValue){EASS_FLOAT, 0, .value.f = (float)(x)},       \
+                           double: (DynamicValue){EASS_FLOAT, 0, .value.f = (float)(x)},      \
+                           long double: (DynamicValue){EASS_FLOAT, 0, .value.f = (float)(x)}, \
+                           default: (DynamicValue){EASS_INT, 0, .value.i = (int)(x)})
 
-// Function to print values to the console
-void print(const char* format, ...) {
-    va_list args;
-    va_start(args, format);
+// Macro to pack one argument of print_typed() into an EassArg without copying it
+#define EASS_ARG(x) _Generic((x),                                                      \
+    _Bool: _eass_arg_int, char: _eass_arg_int, signed char: _eass_arg_int,            \
+    short: _eass_arg_int, int: _eass_arg_int, long: _eass_arg_int,                     \
+    long long: _eass_arg_int, unsigned char: _eass_arg_int,                            \
+    unsigned short: _eass_arg_int, unsigned int: _eass_arg_int,                        \
+    unsigned long: _eass_arg_uint, unsigned long long: _eass_arg_uint,                 \
+    float: _eass_arg_float, double: _eass_arg_double, long double: _eass_arg_double,   \
+    char*: _eass_arg_string, const char*: _eass_arg_string,                            \
+    DynamicValue: _eass_arg_value, DynamicValue*: _eass_arg_ref,                       \
+    const DynamicValue*: _eass_arg_ref)(x)
 
-    while (*format != '\0') {
-        if (*format == '{' && *(format + 1) == '}') {
-            format += 2; // Move the pointer after "{}"
+// Helpers to count the arguments of print_typed() (format included) and pack them on the stack
+#define EASS_CONCAT_(a, b) a##b
+#define EASS_CONCAT(a, b) EASS_CONCAT_(a, b)
+#define EASS_NARGS(...) EASS_NARGS_(__VA_ARGS__, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define EASS_NARGS_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, N, ...) N
+#define EASS_PACK_1(fn, f) fn(f, NULL, 0)
+#define EASS_PACK_2(fn, f, a1) fn(f, (const EassArg[]){EASS_ARG(a1)}, 1)
+#define EASS_PACK_3(fn, f, a1, a2) fn(f, (const EassArg[]){EASS_ARG(a1), EASS_ARG(a2)}, 2)
+#define EASS_PACK_4(fn, f, a1, a2, a3) fn(f, (const EassArg[]){EASS_ARG(a1), EASS_ARG(a2), EASS_ARG(a3)}, 3)
+#define EASS_PACK_5(fn, f, a1, a2, a3, a4) fn(f, (const EassArg[]){EASS_ARG(a1), EASS_ARG(a2), EASS_ARG(a3), EASS_ARG(a4)}, 4)
+#define EASS_PACK_6(fn, f, a1, a2, a3, a4, a5) fn(f, (const EassArg[]){EASS_ARG(a1), EASS_ARG(a2), EASS_ARG(a3), EASS_ARG(a4), EASS_ARG(a5)}, 5)
+#define EASS_PACK_7(fn, f, a1, a2, a3, a4, a5, a6) fn(f, (const EassArg[]){EASS_ARG(a1), EASS_ARG(a2), EASS_ARG(a3), EASS_ARG(a4), EASS_ARG(a5), EASS_ARG(a6)}, 6)
+#define EASS_PACK_8(fn, f, a1, a2, a3, a4, a5, a6, a7) fn(f, (const EassArg[]){EASS_ARG(a1), EASS_ARG(a2), EASS_ARG(a3), EASS_ARG(a4), EASS_ARG(a5), EASS_ARG(a6), EASS_ARG(a7)}, 7)
+#define EASS_PACK_9(fn, f, a1, a2, a3, a4, a5, a6, a7, a8) fn(f, (const EassArg[]){EASS_ARG(a1), EASS_ARG(a2), EASS_ARG(a3), EASS_ARG(a4), EASS_ARG(a5), EASS_ARG(a6), EASS_ARG(a7), EASS_ARG(a8)}, 8)
+#define EASS_PACK_10(fn, f, a1, a2, a3, a4, a5, a6, a7, a8, a9) fn(f, (const EassArg[]){EASS_ARG(a1), EASS_ARG(a2), EASS_ARG(a3), EASS_ARG(a4), EASS_ARG(a5), EASS_ARG(a6), EASS_ARG(a7), EASS_ARG(a8), EASS_ARG(a9)}, 9)
+#define EASS_PACK_11(fn, f, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10) fn(f, (const EassArg[]){EASS_ARG(a1), EASS_ARG(a2), EASS_ARG(a3), EASS_ARG(a4), EASS_ARG(a5), EASS_ARG(a6), EASS_ARG(a7), EASS_ARG(a8), EASS_ARG(a9), EASS_ARG(a10)}, 10)
+#define EASS_PACK_12(fn, f, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11) fn(f, (const EassArg[]){EASS_ARG(a1), EASS_ARG(a2), EASS_ARG(a3), EASS_ARG(a4), EASS_ARG(a5), EASS_ARG(a6), EASS_ARG(a7), EASS_ARG(a8), EASS_ARG(a9), EASS_ARG(a10), EASS_ARG(a11)}, 11)
+#define EASS_PACK_13(fn, f, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12) fn(f, (const EassArg[]){EASS_ARG(a1), EASS_ARG(a2), EASS_ARG(a3), EASS_ARG(a4), EASS_ARG(a5), EASS_ARG(a6), EASS_ARG(a7), EASS_ARG(a8), EASS_ARG(a9), EASS_ARG(a10), EASS_ARG(a11), EASS_ARG(a12)}, 12)
+#define EASS_PACK_14(fn, f, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13) fn(f, (const EassArg[]){EASS_ARG(a1), EASS_ARG(a2), EASS_ARG(a3), EASS_ARG(a4), EASS_ARG(a5), EASS_ARG(a6), EASS_ARG(a7), EASS_ARG(a8), EASS_ARG(a9), EASS_ARG(a10), EASS_ARG(a11), EASS_ARG(a12), EASS_ARG(a13)}, 13)
+#define EASS_PACK_15(fn, f, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14) fn(f, (const EassArg[]){EASS_ARG(a1), EASS_ARG(a2), EASS_ARG(a3), EASS_ARG(a4), EASS_ARG(a5), EASS_ARG(a6), EASS_ARG(a7), EASS_ARG(a8), EASS_ARG(a9), EASS_ARG(a10), EASS_ARG(a11), EASS_ARG(a12), EASS_ARG(a13), EASS_ARG(a14)}, 14)
+#define EASS_PACK_16(fn, f, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15) fn(f, (const EassArg[]){EASS_ARG(a1), EASS_ARG(a2), EASS_ARG(a3), EASS_ARG(a4), EASS_ARG(a5), EASS_ARG(a6), EASS_ARG(a7), EASS_ARG(a8), EASS_ARG(a9), EASS_ARG(a10), EASS_ARG(a11), EASS_ARG(a12), EASS_ARG(a13), EASS_ARG(a14), EASS_ARG(a15)}, 15)
+#define EASS_PACK_17(fn, f, a1, a2, a3, a4, a5, a6, a7, a8, a9, a10, a11, a12, a13, a14, a15, a16) fn(f, (const EassArg[]){EASS_ARG(a1), EASS_ARG(a2), EASS_ARG(a3), EASS_ARG(a4), EASS_ARG(a5), EASS_ARG(a6), EASS_ARG(a7), EASS_ARG(a8), EASS_ARG(a9), EASS_ARG(a10), EASS_ARG(a11), EASS_ARG(a12), EASS_ARG(a13), EASS_ARG(a14), EASS_ARG(a15), EASS_ARG(a16)}, 16)
 
-            // Get the argument as a DynamicValue
-            DynamicValue val = va_arg(args, DynamicValue);
+// Macros to print and format plain C values (up to 16) without wrapping them in DynamicValue:
+// print_typed("{} is {} years old", name, 42). Arguments are borrowed, never freed.
+#define print_typed(...) EASS_CONCAT(EASS_PACK_, EASS_NARGS(__VA_ARGS__))(print_args, __VA_ARGS__)
+#define string_format_typed(...) EASS_CONCAT(EASS_PACK_, EASS_NARGS(__VA_ARGS__))(string_format_args, __VA_ARGS__)
+#define print_binlog_typed(...) EASS_CONCAT(EASS_PACK_, EASS_NARGS(__VA_ARGS__))(print_binlog_args, __VA_ARGS__)
 
-            if (val.error) {
-                const EassError* error = eass_get_last_error();
-                printf("Error: %d - %s", error->code, error->message);
-                va_end(args);
-                return; // Exit the function on error
-            }
-            switch (val.type) {
-                case EASS_INT:
-                    printf("%d", val.value.i);
-                    break;
-                case EASS_FLOAT:
-                    printf("%f", val.value.f);
-                    break;
-                case EASS_STRING:
-                    printf("%s", val.value.s);
-                    break;
-                 case EASS_ARRAY:
-                    printf("Array[");
-                    for(size_t i = 0; i < val.value.a.size; ++i) {
-                        DynamicValue elem = val.value.a.data[i];
-                        if(elem.type == EASS_INT) {
-                           printf("%d", elem.value.i);
-                        }
-                        else if (elem.type == EASS_FLOAT){
-                            printf("%f", elem.value.f);
-                        }
-                        else if (elem.type == EASS_STRING){
-                             printf("%s", elem.value.s);
-                        }
-                        if (i < val.value.a.size - 1){
-                            printf(", ");
-                        }
-                    }
-                    printf("]");
-                    break;
-                case EASS_NULL:
-                    printf("NULL");
-                    break;
-                default:
-                    printf("Unknown");
+// Constructors used by EASS_ARG()
+static const DynamicValue _eass_null_value = {EASS_NULL, 0, .value.i = 0};
+static const DynamicValue _eass_error_value = {EASS_NULL, 1, .value.i = 0};
+
+static inline EassArg _eass_arg_int(long long x) {
+    EassArg arg = {EASS_ARG_INT, {.i = x}};
+    return arg;
+}
+
+static inline EassArg _eass_arg_uint(unsigned long long x) {
+    EassArg arg = {EASS_ARG_UINT, {.u = x}};
+    return arg;
+}
+
+static inline EassArg _eass_arg_float(float x) {
+    EassArg arg = {EASS_ARG_FLOAT, {.f = x}};
+    return arg;
+}
+
+static inline EassArg _eass_arg_double(double x) {
+    EassArg arg = {EASS_ARG_DOUBLE, {.d = x}};
+    return arg;
+}
+
+static inline EassArg _eass_arg_string(const char* x) {
+    EassArg arg = {EASS_ARG_STRING, {.s = x}};
+    return arg;
+}
+
+static inline EassArg _eass_arg_ref(const DynamicValue* x) {
+    EassArg arg = {EASS_ARG_VALUE, {.v = x ? x : &_eass_null_value}};
+    return arg;
+}
+
+// Internal function to get the text of a string argument, whichever way it was packed
+static inline const char* _eass_arg_text(const EassArg* arg) {
+    return arg->type == EASS_ARG_INLINE ? arg->as.sso : arg->as.s;
+}
+
+// A DynamicValue passed by value only lives for this call, so keep what it points to instead
+static inline EassArg _eass_arg_value(DynamicValue x) {
+    EassArg arg = {EASS_ARG_VALUE, {.v = x.error ? &_eass_error_value : &_eass_null_value}};
+    if (x.error) {
+        return arg;
+    }
+    switch (x.type) {
+        case EASS_INT:
+            arg.type = EASS_ARG_INT;
+            arg.as.i = x.value.i;
+            break;
+        case EASS_FLOAT:
+            arg.type = EASS_ARG_FLOAT;
+            arg.as.f = x.value.f;
+            break;
+        case EASS_STRING:
+            if (x.flags & EASS_FLAG_INLINE) {
+                // x is a copy that ends with this call, so take the text along
+                arg.type = EASS_ARG_INLINE;
+                memcpy(arg.as.sso, x.value.sso, EASS_SSO_SIZE);
+            } else {
+                arg.type = EASS_ARG_STRING;
+                arg.as.s = x.value.s;
             }
-           free_dynamic_value(&val); // Clean up the DynamicValue
-        } else {
-            putchar(*format);
-            format++;
-        }
+            break;
+        case EASS_STRVIEW:
+            arg.type = EASS_ARG_VIEW;
+            arg.as.sv.data = EASS_VIEW_DATA(x);
+            arg.as.sv.length = EASS_VIEW_LENGTH(x);
+            break;
+        case EASS_ARRAY:
+            arg.type = EASS_ARG_ARRAY;
+            arg.as.a.data = EASS_ARRAY_OF(x)->data;
+            arg.as.a.size = EASS_ARRAY_OF(x)->size;
+            arg.as.a.storage = EASS_ARRAY_OF(x)->storage;
+            break;
+        default:
+            break;
     }
-    va_end(args);
-    printf("\n");
+    return arg;
 }
 
-// Function to read input from the console and automatically convert it to the appropriate data type.
-DynamicValue input(const char* prompt) {
-    printf("%s", prompt);
-    char* buffer = NULL;
-    size_t len = 0;
-    if (getline(&buffer, &len, stdin) == -1) {
-        _set_error(errno, "getline failed");
-        return (DynamicValue){EASS_STRING, 1, .value.s = strdup("")};
-    }
+// Pairs of decimal digits "00".."99" for converting two digits per division
+static const char _eass_digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
 
-    // Remove trailing newline character
-    if (buffer[strlen(buffer) - 1] == '\n') {
-        buffer[strlen(buffer) - 1] = '\0';
+// Internal function to write the decimal digits of an unsigned value; returns the length
+static size_t _eass_format_uint32(char* buf, uint32_t value) {
+    char tmp[10];
+    char* p = tmp + sizeof(tmp);
+    while (value >= 100) {
+        uint32_t pair = value % 100;
+        value /= 100;
+        p -= 2;
+        memcpy(p, _eass_digit_pairs + pair * 2, 2);
+    }
+    if (value >= 10) {
+        p -= 2;
+        memcpy(p, _eass_digit_pairs + value * 2, 2);
+    } else {
+        *--p = (char)('0' + value);
     }
+    size_t len = (size_t)(tmp + sizeof(tmp) - p);
+    memcpy(buf, p, len);
+    return len;
+}
 
-    if (buffer[0] == '\0') {
-        free(buffer);
-        return (DynamicValue){EASS_STRING, 0, .value.s = strdup("")};
+// Internal function to write the decimal digits of a 64-bit unsigned value; returns the length
+static size_t _eass_format_uint64(char* buf, uint64_t value) {
+    if (value <= UINT32_MAX) {
+        return _eass_format_uint32(buf, (uint32_t)value);
+    }
+    char tmp[20];
+    char* p = tmp + sizeof(tmp);
+    while (value >= 100) {
+        uint64_t pair = value % 100;
+        value /= 100;
+        p -= 2;
+        memcpy(p, _eass_digit_pairs + pair * 2, 2);
+    }
+    if (value >= 10) {
+        p -= 2;
+        memcpy(p, _eass_digit_pairs + value * 2, 2);
+    } else {
+        *--p = (char)('0' + value);
     }
+    size_t len = (size_t)(tmp + sizeof(tmp) - p);
+    memcpy(buf, p, len);
+    return len;
+}
 
-    // Attempt to convert to integer
-    char* endptr;
-    long int_val = strtol(buffer, &endptr, 10);
-     if (*endptr == '\0') {
-        free(buffer);
-        return (DynamicValue){EASS_INT, 0, .value.i = (int)int_val};
+// Internal function to write a 64-bit int; buf needs room for 20 characters
+static size_t _eass_format_int64(char* buf, long long value) {
+    if (value < 0) {
+        buf[0] = '-';
+        return 1 + _eass_format_uint64(buf + 1, 0u - (uint64_t)value);
     }
+    return _eass_format_uint64(buf, (uint64_t)value);
+}
 
-    // Attempt to convert to float
-    float float_val = strtof(buffer, &endptr);
-     if (*endptr == '\0') {
-        free(buffer);
-        return (DynamicValue){EASS_FLOAT, 0, .value.f = float_val};
+// Internal function to write an int without printf(); buf needs room for 11 characters
+static size_t _eass_format_int(char* buf, int value) {
+    if (value < 0) {
+        buf[0] = '-';
+        return 1 + _eass_format_uint32(buf + 1, 0u - (uint32_t)value);
     }
+    return _eass_format_uint32(buf, (uint32_t)value);
+}
+
+// Tables for the shortest round-trip float conversion (Ryu, Ulf Adams 2018):
+// _eass_pow5_inv_split[q] = floor(2^(pow5bits(q) + 58) / 5^q) + 1
+// _eass_pow5_split[i]     = the 61 most significant bits of 5^i
+#define EASS_POW5_INV_BITCOUNT 59
+#define EASS_POW5_BITCOUNT 61
+
+static const uint64_t _eass_pow5_inv_split[31] = {
+    576460752303423489ull, 461168601842738791ull, 368934881474191033ull, 295147905179352826ull,
+    472236648286964522ull, 377789318629571618ull, 302231454903657294ull, 483570327845851670ull,
+    386856262276681336ull, 309485009821345069ull, 495176015714152110ull, 396140812571321688ull,
+    316912650057057351ull, 507060240091291761ull, 405648192073033409ull, 324518553658426727ull,
+    519229685853482763ull, 415383748682786211ull, 332306998946228969ull, 531691198313966350ull,
+    425352958651173080ull, 340282366920938464ull, 544451787073501542ull, 435561429658801234ull,
+    348449143727040987ull, 557518629963265579ull, 446014903970612463ull, 356811923176489971ull,
+    570899077082383953ull, 456719261665907162ull, 365375409332725730ull
+};
+
+static const uint64_t _eass_pow5_split[48] = {
+    1152921504606846976ull, 1441151880758558720ull, 1801439850948198400ull, 2251799813685248000ull,
+    1407374883553280000ull, 1759218604441600000ull, 2199023255552000000ull, 1374389534720000000ull,
+    1717986918400000000ull, 2147483648000000000ull, 1342177280000000000ull, 1677721600000000000ull,
+    2097152000000000000ull, 1310720000000000000ull, 1638400000000000000ull, 2048000000000000000ull,
+    1280000000000000000ull, 1600000000000000000ull, 2000000000000000000ull, 1250000000000000000ull,
+    1562500000000000000ull, 1953125000000000000ull, 1220703125000000000ull, 1525878906250000000ull,
+    1907348632812500000ull, 1192092895507812500ull, 1490116119384765625ull, 1862645149230957031ull,
+    1164153218269348144ull, 1455191522836685180ull, 1818989403545856475ull, 2273736754432320594ull,
+    1421085471520200371ull, 1776356839400250464ull, 2220446049250313080ull, 1387778780781445675ull,
+    1734723475976807094ull, 2168404344971008868ull, 1355252715606880542ull, 1694065894508600678ull,
+    2117582368135750847ull, 1323488980084844279ull, 1654361225106055349ull, 2067951531382569187ull,
+    1292469707114105741ull, 1615587133892632177ull, 2019483917365790221ull, 1262177448353618888ull
+};
 
-    // If it's not a number, return it as a string
-    return (DynamicValue){EASS_STRING, 0, .value.s = strdup(buffer)};
+// ceil(log2(5^e)) for e > 0, 1 for e == 0
+static int32_t _eass_pow5bits(int32_t e) {
+    return (int32_t)(((uint32_t)e * 1217359) >> 19) + 1;
 }
 
-// Function to print an integer in hexadecimal and binary formats
-void printhd(int number) {
-    printf("Hex: 0x%x | Binary: 0b", number);
-    for (int i = 31; i >= 0; i--) {
-        int bit = (number >> i) & 1;
-        printf("%d", bit);
-        if (i % 4 == 0 && i != 0) {
-            printf(" "); // Add space after every 4 bits
-        }
+// floor(log10(2^e))
+static uint32_t _eass_log10_pow2(int32_t e) {
+    return ((uint32_t)e * 78913) >> 18;
+}
+
+// floor(log10(5^e))
+static uint32_t _eass_log10_pow5(int32_t e) {
+    return ((uint32_t)e * 732923) >> 20;
+}
+
+static int _eass_multiple_of_pow5(uint32_t value, uint32_t p) {
+    uint32_t count = 0;
+    while (value % 5 == 0) {
+        value /= 5;
+        count++;
+    }
+    return count >= p;
+}
+
+static int _eass_multiple_of_pow2(uint32_t value, uint32_t p) {
+    return (value & ((1u << p) - 1)) == 0;
+}
+
+// (m * factor) >> shift for a 64-bit factor and shift > 32
+static uint32_t _eass_mul_shift32(uint32_t m, uint64_t factor, int32_t shift) {
+    uint64_t bits0 = (uint64_t)m * (uint32_t)factor;
+    uint64_t bits1 = (uint64_t)m * (uint32_t)(factor >> 32);
+    uint64_t sum = (bits0 >> 32) + bits1;
+    return (uint32_t)(sum >> (shift - 32));
+}
+
+// Internal function to find the shortest decimal digits that read back as the same float.
+// Returns the digits in *digits and the power of ten they are scaled by in *exponent.
+static void _eass_float_shortest(uint32_t mantissa, uint32_t biased_exponent, uint32_t* digits, int32_t* exponent) {
+    int32_t e2;
+    uint32_t m2;
+    if (biased_exponent == 0) {
+        e2 = 1 - 127 - 23 - 2;
+        m2 = mantissa;
+    } else {
+        e2 = (int32_t)biased_exponent - 127 - 23 - 2;
+        m2 = (1u << 23) | mantissa;
+    }
+    int accept_bounds = (m2 & 1) == 0;
+
+    // The value and the halfway points to its neighbours, all scaled by 4
+    uint32_t mv = 4 * m2;
+    uint32_t mp = 4 * m2 + 2;
+    uint32_t mm_shift = (mantissa != 0 || biased_exponent <= 1);
+    uint32_t mm = 4 * m2 - 1 - mm_shift;
+
+    uint32_t vr, vp, vm;
+    int32_t e10;
+    int vm_trailing_zeros = 0;
+    int vr_trailing_zeros = 0;
+    uint32_t last_removed_digit = 0;
+    if (e2 >= 0) {
+        uint32_t q = _eass_log10_pow2(e2);
+        e10 = (int32_t)q;
+        int32_t k = EASS_POW5_INV_BITCOUNT + _eass_pow5bits((int32_t)q) - 1;
+        int32_t i = -e2 + (int32_t)q + k;
+        vr = _eass_mul_shift32(mv, _eass_pow5_inv_split[q], i);
+        vp = _eass_mul_shift32(mp, _eass_pow5_inv_split[q], i);
+        vm = _eass_mul_shift32(mm, _eass_pow5_inv_split[q], i);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            int32_t l = EASS_POW5_INV_BITCOUNT + _eass_pow5bits((int32_t)q - 1) - 1;
+            last_removed_digit = _eass_mul_shift32(mv, _eass_pow5_inv_split[q - 1], -e2 + (int32_t)q - 1 + l) % 10;
+        }
+        if (q <= 9) {
+            if (mv % 5 == 0) {
+                vr_trailing_zeros = _eass_multiple_of_pow5(mv, q);
+            } else if (accept_bounds) {
+                vm_trailing_zeros = _eass_multiple_of_pow5(mm, q);
+            } else {
+                vp -= (uint32_t)_eass_multiple_of_pow5(mp, q);
+            }
+        }
+    } else {
+        uint32_t q = _eass_log10_pow5(-e2);
+        e10 = (int32_t)q + e2;
+        int32_t i = -e2 - (int32_t)q;
+        int32_t k = _eass_pow5bits(i) - EASS_POW5_BITCOUNT;
+        int32_t j = (int32_t)q - k;
+        vr = _eass_mul_shift32(mv, _eass_pow5_split[i], j);
+        vp = _eass_mul_shift32(mp, _eass_pow5_split[i], j);
+        vm = _eass_mul_shift32(mm, _eass_pow5_split[i], j);
+        if (q != 0 && (vp - 1) / 10 <= vm / 10) {
+            j = (int32_t)q - 1 - (_eass_pow5bits(i + 1) - EASS_POW5_BITCOUNT);
+            last_removed_digit = _eass_mul_shift32(mv, _eass_pow5_split[i + 1], j) % 10;
+        }
+        if (q <= 1) {
+            vr_trailing_zeros = 1;
+            if (accept_bounds) {
+                vm_trailing_zeros = mm_shift == 1;
+            } else {
+                --vp;
+            }
+        } else if (q < 31) {
+            vr_trailing_zeros = _eass_multiple_of_pow2(mv, q - 1);
+        }
+    }
+
+    // Drop digits while the interval still contains a shorter number
+    int32_t removed = 0;
+    uint32_t output;
+    if (vm_trailing_zeros || vr_trailing_zeros) {
+        while (vp / 10 > vm / 10) {
+            vm_trailing_zeros &= vm % 10 == 0;
+            vr_trailing_zeros &= last_removed_digit == 0;
+            last_removed_digit = vr % 10;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if (vm_trailing_zeros) {
+            while (vm % 10 == 0) {
+                vr_trailing_zeros &= last_removed_digit == 0;
+                last_removed_digit = vr % 10;
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+        if (vr_trailing_zeros && last_removed_digit == 5 && vr % 2 == 0) {
+            last_removed_digit = 4; // Round half to even
+        }
+        output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) || last_removed_digit >= 5);
+    } else {
+        while (vp / 10 > vm / 10) {
+            last_removed_digit = vr % 10;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        output = vr + (vr == vm || last_removed_digit >= 5);
+    }
+    *digits = output;
+    *exponent = e10 + removed;
+}
+
+// Internal function to lay out significant digits the way Python's repr() does. text holds
+// count digits, point is the position of the decimal point relative to them, and the first
+// len bytes of buf (a sign, if any) are kept.
+static size_t _eass_format_digits(char* buf, size_t len, const char* text, int32_t count, int32_t point) {
+    if (point > -4 && point <= 16) {
+        if (point <= 0) {
+            // 0.000ddd
+            buf[len++] = '0';
+            buf[len++] = '.';
+            memset(buf + len, '0', (size_t)-point);
+            len += (size_t)-point;
+            memcpy(buf + len, text, (size_t)count);
+            len += (size_t)count;
+        } else if (point >= count) {
+            // ddd000.0
+            memcpy(buf + len, text, (size_t)count);
+            len += (size_t)count;
+            memset(buf + len, '0', (size_t)(point - count));
+            len += (size_t)(point - count);
+            buf[len++] = '.';
+            buf[len++] = '0';
+        } else {
+            // dd.ddd
+            memcpy(buf + len, text, (size_t)point);
+            len += (size_t)point;
+            buf[len++] = '.';
+            memcpy(buf + len, text + point, (size_t)(count - point));
+            len += (size_t)(count - point);
+        }
+        return len;
+    }
+
+    // Scientific notation: d.ddde+XX
+    buf[len++] = text[0];
+    if (count > 1) {
+        buf[len++] = '.';
+        memcpy(buf + len, text + 1, (size_t)(count - 1));
+        len += (size_t)(count - 1);
+    }
+    int32_t sci = point - 1;
+    buf[len++] = 'e';
+    buf[len++] = sci < 0 ? '-' : '+';
+    if (sci < 0) sci = -sci;
+    if (sci >= 100) {
+        buf[len++] = (char)('0' + sci / 100);
+        sci %= 100;
+    }
+    memcpy(buf + len, _eass_digit_pairs + sci * 2, 2);
+    return len + 2;
+}
+
+// Internal function to write a float as the shortest text that reads back exactly, the way
+// Python's repr() does: 0.1, 2.5, 100.0, 1e-05, 1.5e+20. buf needs room for 24 characters.
+static size_t _eass_format_float(char* buf, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    uint32_t mantissa = bits & ((1u << 23) - 1);
+    uint32_t biased_exponent = (bits >> 23) & 0xff;
+    size_t len = 0;
+
+    if (biased_exponent == 0xff) {
+        if (mantissa != 0) {
+            memcpy(buf, "nan", 3);
+            return 3;
+        }
+        if (bits >> 31) buf[len++] = '-';
+        memcpy(buf + len, "inf", 3);
+        return len + 3;
+    }
+    if (bits >> 31) {
+        buf[len++] = '-';
+    }
+    if (biased_exponent == 0 && mantissa == 0) {
+        memcpy(buf + len, "0.0", 3);
+        return len + 3;
+    }
+
+    uint32_t digits;
+    int32_t exponent;
+    _eass_float_shortest(mantissa, biased_exponent, &digits, &exponent);
+    char text[10];
+    int32_t count = (int32_t)_eass_format_uint32(text, digits);
+    return _eass_format_digits(buf, len, text, count, count + exponent);
+}
+
+// Internal function to write a double as the shortest text that reads back exactly, laid out
+// like _eass_format_float(). Doubles are only produced by print_typed() and friends, so this
+// searches with snprintf("%.*e") and strtod() instead of carrying 64-bit Ryu tables.
+// buf needs room for 32 characters.
+static size_t _eass_format_double(char* buf, double value) {
+    size_t len = 0;
+    if (isnan(value)) {
+        memcpy(buf, "nan", 3);
+        return 3;
+    }
+    if (signbit(value)) {
+        buf[len++] = '-';
+        value = -value;
+    }
+    if (isinf(value)) {
+        memcpy(buf + len, "inf", 3);
+        return len + 3;
+    }
+    if (value == 0.0) {
+        memcpy(buf + len, "0.0", 3);
+        return len + 3;
+    }
+
+    // Any normal double with at most 15 significant digits is recovered exactly from %.14e;
+    // subnormals carry fewer significant bits, so search those from a single digit up
+    char tmp[40];
+    for (int precision = (value < DBL_MIN) ? 1 : 15; precision <= 17; precision++) {
+        snprintf(tmp, sizeof(tmp), "%.*e", precision - 1, value);
+        if (precision == 17 || strtod(tmp, NULL) == value) {
+            break;
+        }
+    }
+
+    // Collect the digits, skipping the decimal point whatever the locale makes it
+    char text[20];
+    int32_t count = 0;
+    const char* p = tmp;
+    for (; *p != 'e' && *p != '\0'; p++) {
+        if (*p >= '0' && *p <= '9') {
+            text[count++] = *p;
+        }
+    }
+    int32_t exponent = (*p == 'e') ? (int32_t)strtol(p + 1, NULL, 10) : 0;
+    while (count > 1 && text[count - 1] == '0') {
+        count--;
+    }
+    return _eass_format_digits(buf, len, text, count, exponent + 1);
+}
+
+// Internal function to resize a heap block, without realloc() on embedded systems
+static void* _eass_realloc(void* ptr, size_t old_size, size_t new_size) {
+#ifdef EASS_ENABLE_EMBEDDED
+    void* new_ptr = malloc(new_size);
+    if (new_ptr && ptr) {
+        memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+        free(ptr);
+    }
+    return new_ptr;
+#else
+    (void)old_size;
+    return realloc(ptr, new_size);
+#endif
+}
+
+// Internal function to write raw bytes to a file descriptor, bypassing stdio
+static int _eass_write_fd(int fd, const char* data, size_t len) {
+#if defined(_WIN32)
+    while (len > 0) {
+        int written = _write(fd, data, (unsigned int)len);
+        if (written < 0) {
+            _set_error(errno, "_write failed in eass_sink_flush");
+            return -1;
+        }
+        data += written;
+        len -= (size_t)written;
+    }
+    return 0;
+#elif defined(__linux__) || defined(__APPLE__)
+    while (len > 0) {
+        ssize_t written = write(fd, data, len);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            _set_error(errno, "write failed in eass_sink_flush");
+            return -1;
+        }
+        data += written;
+        len -= (size_t)written;
+    }
+    return 0;
+#else
+    (void)fd;
+    (void)data;
+    (void)len;
+    _set_error(ENOSYS, "File descriptors are not supported on this platform");
+    return -1;
+#endif
+}
+
+// Function to create a sink that writes to a stdio stream
+EassSink eass_sink_file(FILE* file) {
+    EassSink sink = {EASS_SINK_FILE, file, -1, NULL, 0, 0, 0, 0, NULL};
+    return sink;
+}
+
+// Function to create a sink that writes to a file descriptor with write(2)
+EassSink eass_sink_fd(int fd) {
+    EassSink sink = {EASS_SINK_FD, NULL, fd, NULL, 0, 0, 0, 0, NULL};
+    return sink;
+}
+
+// Function to create a sink that writes into a caller buffer, truncating like snprintf()
+EassSink eass_sink_buffer(char* buf, size_t capacity) {
+    EassSink sink = {EASS_SINK_BUFFER, NULL, -1, buf, 0, capacity, 0, 0, NULL};
+    if (buf && capacity > 0) {
+        buf[0] = '\0';
+    }
+    return sink;
+}
+
+// Function to create a sink that collects output in a growing heap buffer
+EassSink eass_sink_memory(void) {
+    EassSink sink = {EASS_SINK_MEMORY, NULL, -1, NULL, 0, 0, 0, 0, NULL};
+    return sink;
+}
+
+// Function to create a sink that appends to a string builder
+EassSink eass_sink_str(EassStr* str) {
+    EassSink sink = {EASS_SINK_STRING, NULL, -1, NULL, 0, 0, 0, 0, str};
+    return sink;
+}
+
+// Function to write out the bytes a file or descriptor sink is holding
+int eass_sink_flush(EassSink* sink) {
+    if (sink == NULL) {
+        _set_error(EINVAL, "eass_sink_flush called with NULL sink");
+        return -1;
+    }
+    if (sink->size == 0 || (sink->kind != EASS_SINK_FILE && sink->kind != EASS_SINK_FD)) {
+        return 0;
+    }
+    int result = 0;
+    if (sink->kind == EASS_SINK_FD) {
+        result = _eass_write_fd(sink->fd, sink->data, sink->size);
+    } else if (fwrite(sink->data, 1, sink->size, sink->file) != sink->size) {
+        _set_error(errno, "fwrite failed in eass_sink_flush");
+        result = -1;
+    }
+    if (result != 0) {
+        sink->error = 1;
+    }
+    sink->size = 0;
+    return result;
+}
+
+// Function to free the heap buffer of a memory sink
+void eass_sink_free(EassSink* sink) {
+    if (sink && sink->kind == EASS_SINK_MEMORY) {
+        free(sink->data);
+        sink->data = NULL;
+        sink->size = 0;
+        sink->capacity = 0;
+    }
+}
+
+// Internal function to make room for len more bytes (plus a terminator) in a memory sink
+static int _eass_sink_grow(EassSink* sink, size_t len) {
+    size_t needed = sink->size + len + 1;
+    if (needed <= sink->capacity) {
+        return 0;
+    }
+    size_t new_cap = sink->capacity + (sink->capacity >> 1);
+    if (new_cap < needed) new_cap = needed;
+    if (new_cap < 64) new_cap = 64;
+    char* new_data = (char*)_eass_realloc(sink->data, sink->capacity, new_cap);
+    if (!new_data) {
+        _set_error(ENOMEM, "realloc failed in memory sink");
+        sink->error = 1;
+        return -1;
+    }
+    sink->data = new_data;
+    sink->capacity = new_cap;
+    return 0;
+}
+
+// Internal function to append bytes to a sink
+static void _eass_sink_write(EassSink* sink, const char* data, size_t len) {
+    sink->total += len;
+    switch (sink->kind) {
+        case EASS_SINK_BUFFER: {
+            // Keep room for the terminator and drop what does not fit
+            size_t room = sink->capacity > sink->size ? sink->capacity - sink->size - 1 : 0;
+            if (len > room) len = room;
+            if (len == 0) return;
+            memcpy(sink->data + sink->size, data, len);
+            sink->size += len;
+            break;
+        }
+        case EASS_SINK_MEMORY:
+            if (_eass_sink_grow(sink, len) != 0) return;
+            memcpy(sink->data + sink->size, data, len);
+            sink->size += len;
+            break;
+        case EASS_SINK_STRING:
+            if (eass_str_append(sink->str, data, len) != 0) sink->error = 1;
+            break;
+        default:
+            if (sink->size + len > sink->capacity) {
+                eass_sink_flush(sink);
+                if (len > sink->capacity) {
+                    // Too large to hold, write it through
+                    EassSink direct = *sink;
+                    direct.data = (char*)data;
+                    direct.size = len;
+                    if (eass_sink_flush(&direct) != 0) sink->error = 1;
+                    return;
+                }
+            }
+            memcpy(sink->data + sink->size, data, len);
+            sink->size += len;
+            break;
+    }
+}
+
+// Internal function to terminate the text of a buffer or memory sink
+static void _eass_sink_terminate(EassSink* sink) {
+    if (sink->kind == EASS_SINK_MEMORY && _eass_sink_grow(sink, 0) != 0) {
+        return;
+    }
+    if ((sink->kind == EASS_SINK_BUFFER || sink->kind == EASS_SINK_MEMORY) && sink->capacity > 0) {
+        sink->data[sink->size] = '\0';
+    }
+}
+
+// Internal function to format into a sink like printf(); text that does not fit the stack buffer
+// is formatted again on the heap
+static void _eass_sink_printf(EassSink* sink, const char* format, ...) {
+    char tmp[128];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(tmp, sizeof(tmp), format, args);
+    va_end(args);
+    if (len <= 0) {
+        return;
+    }
+    if ((size_t)len < sizeof(tmp)) {
+        _eass_sink_write(sink, tmp, (size_t)len);
+        return;
+    }
+    char* heap = (char*)malloc((size_t)len + 1);
+    if (!heap) {
+        _eass_sink_write(sink, tmp, sizeof(tmp) - 1); // Out of memory: keep what fits
+        return;
+    }
+    va_start(args, format);
+    vsnprintf(heap, (size_t)len + 1, format, args);
+    va_end(args);
+    _eass_sink_write(sink, heap, (size_t)len);
+    free(heap);
+}
+
+// Per-thread output buffer used by print() and printhd()
+typedef struct {
+    EassSink sink;
+    char data[EASS_OUTPUT_BUFFER_SIZE];
+} EassOutputBuffer;
+
+static EASS_THREAD_LOCAL EassOutputBuffer _eass_output;
+static EassFlushPolicy _eass_flush_policy = EASS_FLUSH_LINE;
+static int _eass_output_atexit_registered = 0;
+
+static void _eass_flush_at_exit(void) {
+    eass_flush();
+}
+
+// Internal function to create an unbuffered sink for standard output
+static EassSink _eass_stdout_target(void) {
+#if (defined(__linux__) || defined(__APPLE__)) && !defined(EASS_ENABLE_EMBEDDED)
+    return eass_sink_fd(STDOUT_FILENO);
+#else
+    return eass_sink_file(stdout);
+#endif
+}
+
+// Internal function to get the calling thread's standard output sink
+static EassSink* _eass_stdout_sink(void) {
+    EassSink* sink = &_eass_output.sink;
+    if (sink->data == NULL) {
+        *sink = _eass_stdout_target();
+        sink->data = _eass_output.data;
+        sink->capacity = EASS_OUTPUT_BUFFER_SIZE;
+        if (!_eass_output_atexit_registered) {
+            _eass_output_atexit_registered = 1;
+            atexit(_eass_flush_at_exit);
+        }
+    }
+    return sink;
+}
+
+// Function to write everything buffered by print() on the calling thread
+int eass_flush(void) {
+    EassSink* sink = &_eass_output.sink;
+    if (sink->size == 0) {
+        return 0;
+    }
+    // Anything the caller wrote with printf() must appear before our buffered text
+    fflush(stdout);
+    int result = eass_sink_flush(sink);
+    if (sink->kind == EASS_SINK_FILE) {
+        fflush(sink->file);
+    }
+    return result;
+}
+
+// Function to choose when print() hands its buffered output to the operating system
+void eass_set_flush_policy(EassFlushPolicy policy) {
+    _eass_flush_policy = policy;
+}
+
+#if defined(EASS_USE_AVX2) || defined(EASS_USE_SSE2)
+// Index of the lowest set bit of a non-zero mask
+static unsigned _eass_ctz32(unsigned mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+}
+#endif
+
+// Internal function to find the next '{' or the terminating '\0' of a string.
+// Loads are aligned to the vector size, so they never cross into an unmapped page.
+EASS_NO_SANITIZE_ADDRESS
+static const char* _eass_find_brace(const char* p) {
+#if defined(EASS_USE_AVX2)
+    size_t misalign = (uintptr_t)p & 31;
+    const __m256i* block = (const __m256i*)(p - misalign);
+    const __m256i brace = _mm256_set1_epi8('{');
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i chunk = _mm256_load_si256(block);
+    unsigned mask = (unsigned)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, brace), _mm256_cmpeq_epi8(chunk, zero)));
+    mask >>= misalign; // Ignore the bytes before p
+    while (mask == 0) {
+        p += 32 - misalign;
+        misalign = 0;
+        chunk = _mm256_load_si256(++block);
+        mask = (unsigned)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, brace), _mm256_cmpeq_epi8(chunk, zero)));
+    }
+    return p + _eass_ctz32(mask);
+#elif defined(EASS_USE_SSE2)
+    size_t misalign = (uintptr_t)p & 15;
+    const __m128i* block = (const __m128i*)(p - misalign);
+    const __m128i brace = _mm_set1_epi8('{');
+    const __m128i zero = _mm_setzero_si128();
+    __m128i chunk = _mm_load_si128(block);
+    unsigned mask = (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, brace), _mm_cmpeq_epi8(chunk, zero)));
+    mask >>= misalign; // Ignore the bytes before p
+    while (mask == 0) {
+        p += 16 - misalign;
+        misalign = 0;
+        chunk = _mm_load_si128(++block);
+        mask = (unsigned)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, brace), _mm_cmpeq_epi8(chunk, zero)));
+    }
+    return p + _eass_ctz32(mask);
+#else
+    while (*p != '\0' && *p != '{') {
+        p++;
+    }
+    return p;
+#endif
+}
+
+// Internal function to parse the part of a placeholder after ':' up to and including the closing
+// '}', following Python's [[fill]align][sign][#][0][width][.precision][type]. Returns the
+// position after the '}', or NULL if the text is not a valid specification.
+static const char* _eass_format_parse_spec(const char* p, EassFormatSpec* spec) {
+    *spec = (EassFormatSpec){' ', 0, '-', 0, 0, 0, -1};
+    if (p[0] != '\0' && p[0] != '}' && p[1] != '\0' && strchr("<>^=", p[1])) {
+        spec->fill = p[0];
+        spec->align = p[1];
+        p += 2;
+    } else if (*p != '\0' && strchr("<>^=", *p)) {
+        spec->align = *p++;
+    }
+    if (*p == '+' || *p == '-' || *p == ' ') {
+        spec->sign = *p++;
+    }
+    if (*p == '#') {
+        spec->alternate = 1;
+        p++;
+    }
+    if (*p == '0') {
+        if (spec->align == 0) {
+            spec->fill = '0';
+            spec->align = '=';
+        }
+        p++;
+    }
+    while (*p >= '0' && *p <= '9') {
+        if (spec->width < EASS_FORMAT_MAX_WIDTH) spec->width = spec->width * 10 + (*p - '0');
+        p++;
+    }
+    if (spec->width > EASS_FORMAT_MAX_WIDTH) spec->width = EASS_FORMAT_MAX_WIDTH;
+    if (*p == '.') {
+        p++;
+        if (*p < '0' || *p > '9') {
+            return NULL;
+        }
+        spec->precision = 0;
+        while (*p >= '0' && *p <= '9') {
+            if (spec->precision < EASS_FORMAT_MAX_WIDTH) spec->precision = spec->precision * 10 + (*p - '0');
+            p++;
+        }
+        if (spec->precision > EASS_FORMAT_MAX_WIDTH) spec->precision = EASS_FORMAT_MAX_WIDTH;
+    }
+    if (*p != '\0' && *p != '}' && strchr("dxXobcfFeEgG%s", *p)) {
+        spec->type = *p++;
+    }
+    return (*p == '}') ? p + 1 : NULL;
+}
+
+// Internal function to split a template into operations; counts them when ops is NULL
+static size_t _eass_format_parse(const char* format, EassFormatOp* ops, size_t* next_args, int* max_index) {
+    size_t count = 0;
+    const char* p = format;
+    const char* literal = format;
+    *next_args = 0;
+    *max_index = -1;
+
+    for (;;) {
+        p = _eass_find_brace(p); // Skip the literal run in bulk
+        if (*p == '\0') {
+            break;
+        }
+        // A placeholder is "{", an optional index of up to four digits, an optional ":spec"
+        // and "}"; anything else is copied as text
+        EassFormatOp op = {EASS_OP_NEXT_ARG, (size_t)(p - format), 0, 0, 0, {0}};
+        const char* end = p + 1;
+        if (*end >= '0' && *end <= '9') {
+            const char* digits = end;
+            int index = 0;
+            while (*end >= '0' && *end <= '9' && end - digits < 4) {
+                index = index * 10 + (*end++ - '0');
+            }
+            if (*end == '}' || *end == ':') {
+                op.kind = EASS_OP_INDEXED_ARG;
+                op.index = index;
+            }
+        }
+        if (*end == '}') {
+            end++;
+        } else if (*end == ':') {
+            end = _eass_format_parse_spec(end + 1, &op.spec);
+            op.has_spec = 1;
+        } else {
+            end = NULL;
+        }
+        if (end == NULL) {
+            p++;
+            continue;
+        }
+        if (p > literal) {
+            if (ops) ops[count] = (EassFormatOp){EASS_OP_LITERAL, (size_t)(literal - format), (size_t)(p - literal), 0, 0, {0}};
+            count++;
+        }
+        op.length = (size_t)(end - p);
+        if (op.kind == EASS_OP_NEXT_ARG) {
+            (*next_args)++;
+        } else if (op.index > *max_index) {
+            *max_index = op.index;
+        }
+        if (ops) ops[count] = op;
+        count++;
+        p = end;
+        literal = p;
+    }
+    if (p > literal) {
+        if (ops) ops[count] = (EassFormatOp){EASS_OP_LITERAL, (size_t)(literal - format), (size_t)(p - literal), 0, 0, {0}};
+        count++;
+    }
+    return count;
+}
+
+// Function to compile a format template once so it can be reused without re-scanning
+EassFormat* eass_format_compile(const char* format) {
+    if (format == NULL) {
+        _set_error(EINVAL, "eass_format_compile called with NULL format");
+        return NULL;
+    }
+    size_t next_args;
+    int max_index;
+    size_t length = strlen(format);
+    size_t op_count = _eass_format_parse(format, NULL, &next_args, &max_index);
+
+    // The handle, its operations and its copy of the text share one allocation
+    EassFormat* fmt = (EassFormat*)malloc(sizeof(EassFormat) + op_count * sizeof(EassFormatOp) + length + 1);
+    if (!fmt) {
+        _set_error(ENOMEM, "malloc failed in eass_format_compile");
+        return NULL;
+    }
+    fmt->ops = (EassFormatOp*)(fmt + 1);
+    char* text = (char*)(fmt->ops + op_count);
+    memcpy(text, format, length + 1);
+    fmt->text = text;
+    fmt->length = length;
+    fmt->op_count = _eass_format_parse(format, fmt->ops, &fmt->next_args, &fmt->max_index);
+    fmt->binlog_id = 0;
+    fmt->binlog_generation = 0;
+    return fmt;
+}
+
+// Internal function to get the number of arguments a call with this template passes
+static size_t _eass_format_arg_count(const EassFormat* fmt) {
+    size_t count = fmt->next_args;
+    if (fmt->max_index >= 0 && (size_t)fmt->max_index + 1 > count) {
+        count = (size_t)fmt->max_index + 1;
+    }
+    return count;
+}
+
+// Function to free a template returned by eass_format_compile()
+void eass_format_free(EassFormat* fmt) {
+    free(fmt);
+}
+
+// Per-thread cache of compiled templates, keyed by the address of the format string
+typedef struct {
+    const char* key;
+    EassFormat* fmt;
+} EassFormatCacheEntry;
+
+static EASS_THREAD_LOCAL EassFormatCacheEntry _eass_format_cache[EASS_FORMAT_CACHE_SIZE];
+
+#ifdef EASS_HAS_THREADS
+static once_flag _eass_format_cache_once = ONCE_FLAG_INIT;
+static tss_t _eass_format_cache_key;
+static EASS_THREAD_LOCAL int _eass_format_cache_registered;
+
+// Internal function to free a thread's cached templates when the thread exits
+static void _eass_format_cache_thread_exit(void* cache) {
+    EassFormatCacheEntry* entries = (EassFormatCacheEntry*)cache;
+    for (size_t i = 0; i < EASS_FORMAT_CACHE_SIZE; i++) {
+        eass_format_free(entries[i].fmt);
+        entries[i].key = NULL;
+        entries[i].fmt = NULL;
+    }
+}
+
+static void _eass_format_cache_init(void) {
+    tss_create(&_eass_format_cache_key, _eass_format_cache_thread_exit);
+}
+#endif
+
+// Function to free every template cached by the calling thread
+void eass_format_cache_clear(void) {
+    for (size_t i = 0; i < EASS_FORMAT_CACHE_SIZE; i++) {
+        eass_format_free(_eass_format_cache[i].fmt);
+        _eass_format_cache[i].key = NULL;
+        _eass_format_cache[i].fmt = NULL;
+    }
+}
+
+// Internal function to find or compile the template for a format string
+static const EassFormat* _eass_format_lookup(const char* format) {
+    uintptr_t hash = ((uintptr_t)format >> 3) * 2654435761u;
+    EassFormatCacheEntry* entry = &_eass_format_cache[hash % EASS_FORMAT_CACHE_SIZE];
+    if (entry->fmt) {
+#ifdef EASS_FORMAT_CACHE_TRUST_POINTERS
+        int same_address = (entry->key == format);
+#else
+        int same_address = 0; // The same address may hold different text (e.g. a reused buffer)
+#endif
+        if (same_address || (strncmp(entry->fmt->text, format, entry->fmt->length) == 0 && format[entry->fmt->length] == '\0')) {
+            entry->key = format;
+            return entry->fmt;
+        }
+    }
+    EassFormat* fmt = eass_format_compile(format);
+    if (!fmt) {
+        return NULL;
+    }
+#ifdef EASS_HAS_THREADS
+    if (!_eass_format_cache_registered) {
+        call_once(&_eass_format_cache_once, _eass_format_cache_init);
+        tss_set(_eass_format_cache_key, _eass_format_cache);
+        _eass_format_cache_registered = 1;
+    }
+#endif
+    eass_format_free(entry->fmt);
+    entry->key = format;
+    entry->fmt = fmt;
+    return fmt;
+}
+
+static int _eass_sink_value(EassSink* sink, const DynamicValue* val);
+
+// Internal function to get element index of array storage; a packed element is unpacked into tmp,
+// borrowing its string
+static const DynamicValue* _eass_element(const void* data, unsigned char storage, size_t index, DynamicValue* tmp) {
+    switch (storage) {
+        case EASS_STORAGE_INT:
+            *tmp = (DynamicValue){EASS_INT, 0, .value.i = ((const int*)data)[index]};
+            return tmp;
+        case EASS_STORAGE_FLOAT:
+            *tmp = (DynamicValue){EASS_FLOAT, 0, .value.f = ((const float*)data)[index]};
+            return tmp;
+        case EASS_STORAGE_STRING:
+            *tmp = (DynamicValue){EASS_STRING, 0, .value.s = ((char* const*)data)[index]};
+            return tmp;
+        case EASS_STORAGE_INTERNED:
+            *tmp = (DynamicValue){EASS_STRING, 0, EASS_FLAG_INTERNED, .value.s = ((char* const*)data)[index]};
+            return tmp;
+        default:
+            return &((const DynamicValue*)data)[index];
+    }
+}
+
+// Internal function to write array elements as Array[a, b, c]; returns -1 on an error element
+static int _eass_sink_elements(EassSink* sink, const void* data, size_t size, unsigned char storage) {
+    DynamicValue tmp;
+    _eass_sink_write(sink, "Array[", 6);
+    for (size_t i = 0; i < size; ++i) {
+        if (i > 0)
+            _eass_sink_write(sink, ", ", 2);
+        if (_eass_sink_value(sink, _eass_element(data, storage, i, &tmp)) != 0)
+            return -1;
+    }
+    _eass_sink_write(sink, "]", 1);
+    return 0;
+}
+
+// Internal function to write a value to a sink; returns -1 if it or one of its elements is an error value
+static int _eass_sink_value(EassSink* sink, const DynamicValue* val) {
+    char number[32];
+    if (val->error) {
+        return -1;
+    }
+    switch (val->type) {
+        case EASS_INT:
+            _eass_sink_write(sink, number, _eass_format_int(number, val->value.i));
+            break;
+        case EASS_FLOAT:
+            _eass_sink_write(sink, number, _eass_format_float(number, val->value.f));
+            break;
+        case EASS_STRING: {
+            const char* text = string_value(val);
+            if (text)
+                _eass_sink_write(sink, text, strlen(text));
+            else
+                _eass_sink_write(sink, "NULL", 4);
+            break;
+        }
+        case EASS_STRVIEW:
+            _eass_sink_write(sink, EASS_VIEW_DATA(*val), EASS_VIEW_LENGTH(*val));
+            break;
+        case EASS_ARRAY:
+            return _eass_sink_elements(sink, EASS_ARRAY_OF(*val)->data, EASS_ARRAY_OF(*val)->size, EASS_ARRAY_OF(*val)->storage);
+        case EASS_NULL:
+            _eass_sink_write(sink, "NULL", 4);
+            break;
+        default:
+            _eass_sink_write(sink, "Unknown", 7);
+    }
+    return 0;
+}
+
+// Internal function to get the exact number of characters _eass_sink_value() writes for a value;
+// returns -1 if it or one of its elements is an error value
+static int _eass_value_length(const DynamicValue* val, size_t* length) {
+    char number[32];
+    if (val->error) {
+        return -1;
+    }
+    switch (val->type) {
+        case EASS_INT:
+            *length += _eass_format_int(number, val->value.i);
+            break;
+        case EASS_FLOAT:
+            *length += _eass_format_float(number, val->value.f);
+            break;
+        case EASS_STRING:
+            *length += string_value(val) ? strlen(string_value(val)) : 4;
+            break;
+        case EASS_STRVIEW:
+            *length += EASS_VIEW_LENGTH(*val);
+            break;
+        case EASS_ARRAY:
+            *length += 7; // "Array[" and "]"
+            for (size_t i = 0; i < EASS_ARRAY_OF(*val)->size; i++) {
+                DynamicValue tmp;
+                if (i > 0)
+                    *length += 2;
+                if (_eass_value_length(_eass_element(EASS_ARRAY_OF(*val)->data, EASS_ARRAY_OF(*val)->storage, i, &tmp), length) != 0)
+                    return -1;
+            }
+            break;
+        case EASS_NULL:
+            *length += 4;
+            break;
+        default:
+            *length += 7;
+    }
+    return 0;
+}
+
+// Internal function to write n copies of a padding character
+static void _eass_spec_fill(EassSink* sink, char c, size_t n) {
+    char run[32];
+    memset(run, c, sizeof(run));
+    while (n > 0) {
+        size_t chunk = n < sizeof(run) ? n : sizeof(run);
+        _eass_sink_write(sink, run, chunk);
+        n -= chunk;
+    }
+}
+
+// Internal function to write a prefix (sign, radix) and body padded to the width of a specification
+static void _eass_spec_pad(EassSink* sink, const EassFormatSpec* spec, const char* prefix, size_t prefix_len,
+                           const char* body, size_t body_len, int numeric) {
+    size_t length = prefix_len + body_len;
+    size_t pad = (size_t)spec->width > length ? (size_t)spec->width - length : 0;
+    char align = spec->align ? spec->align : (numeric ? '>' : '<');
+    if (align == '=' && !numeric) align = '<';
+    size_t before = (align == '>') ? pad : (align == '^') ? pad / 2 : 0;
+    _eass_spec_fill(sink, spec->fill, before);
+    if (prefix_len > 0) {
+        _eass_sink_write(sink, prefix, prefix_len);
+    }
+    if (align == '=') {
+        _eass_spec_fill(sink, spec->fill, pad);
+        pad = 0;
+    }
+    _eass_sink_write(sink, body, body_len);
+    _eass_spec_fill(sink, spec->fill, pad - before);
+}
+
+// Internal function to write text under a specification; precision limits its length
+static void _eass_spec_text(EassSink* sink, const EassFormatSpec* spec, const char* text, size_t len) {
+    if (spec->precision >= 0 && len > (size_t)spec->precision) {
+        len = (size_t)spec->precision;
+    }
+    _eass_spec_pad(sink, spec, NULL, 0, text, len, 0);
+}
+
+// Internal function to get the sign character a specification puts in front of a number, or 0
+static char _eass_spec_sign(const EassFormatSpec* spec, int negative) {
+    if (negative) return '-';
+    return (spec->sign == '+' || spec->sign == ' ') ? spec->sign : 0;
+}
+
+// Powers of ten that fit in 64 bits
+static const uint64_t _eass_pow10_u64[20] = {
+    1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u,
+    10000000000u, 100000000000u, 1000000000000u, 10000000000000u, 100000000000000u,
+    1000000000000000u, 10000000000000000u, 100000000000000000u, 1000000000000000000u,
+    10000000000000000000u
+};
+
+// Internal function to print mantissa * 2^exponent with a fixed number of decimals, rounded half
+// to even like printf(). Works in 64-bit integers and returns 0 when the value does not fit.
+static size_t _eass_format_fixed(char* buf, uint64_t mantissa, int exponent, int precision) {
+    if (mantissa == 0) {
+        exponent = 0;
+    }
+    while (mantissa != 0 && (mantissa & 1) == 0) {
+        mantissa >>= 1;
+        exponent++;
+    }
+    if (precision > 19 || mantissa > UINT64_MAX / _eass_pow10_u64[precision]) {
+        return 0;
+    }
+    uint64_t scaled = mantissa * _eass_pow10_u64[precision];
+    uint64_t units;
+    if (exponent >= 0) {
+        if (exponent >= 64 || scaled > (UINT64_MAX >> exponent)) {
+            return 0;
+        }
+        units = scaled << exponent;
+    } else if (-exponent < 64) {
+        int shift = -exponent;
+        uint64_t rest = scaled & ((UINT64_MAX >> (64 - shift)));
+        uint64_t half = (uint64_t)1 << (shift - 1);
+        units = scaled >> shift;
+        if (rest > half || (rest == half && (units & 1))) {
+            units++;
+        }
+    } else {
+        // Below one unit in the last place: only exactly half of it at 2^-64 could round up,
+        // and that is a tie that rounds to the even 0
+        units = (-exponent == 64 && scaled > ((uint64_t)1 << 63)) ? 1 : 0;
+    }
+
+    char digits[24];
+    size_t count = _eass_format_uint64(digits, units);
+    size_t len = 0;
+    // Leading zeros so that there is at least one digit before the point
+    size_t zeros = (count <= (size_t)precision) ? (size_t)precision + 1 - count : 0;
+    size_t total = count + zeros;
+    size_t integer_digits = total - (size_t)precision;
+    for (size_t i = 0; i < total; i++) {
+        if (i == integer_digits) buf[len++] = '.';
+        buf[len++] = (i < zeros) ? '0' : digits[i - zeros];
+    }
+    return len;
+}
+
+// Internal function to write an integer under a specification; magnitude is its absolute value
+static void _eass_spec_integer(EassSink* sink, const EassFormatSpec* spec, unsigned long long magnitude, int negative);
+
+// Internal function to write a float or double under a specification; single is non-zero for a
+// float, so that the default form uses the shortest digits of the float
+static void _eass_spec_float(EassSink* sink, const EassFormatSpec* spec, double value, int single) {
+    char type = spec->type;
+    if (type == 'd' || type == 'x' || type == 'X' || type == 'o' || type == 'b' || type == 'c' || type == 's') {
+        type = 0; // Integer and text presentations do not apply to floats
+    }
+    int negative = signbit(value) != 0;
+    double magnitude = negative ? -value : value;
+    char prefix[1];
+    char stack_body[512];
+    char* body = stack_body;
+    size_t len = 0;
+    if (isnan(value) || isinf(value)) {
+        int upper = (type == 'F' || type == 'E' || type == 'G');
+        memcpy(body, isnan(value) ? (upper ? "NAN" : "nan") : (upper ? "INF" : "inf"), 3);
+        len = 3;
+        negative = negative && !isnan(value);
+    } else if (type == 0 && spec->precision < 0) {
+        len = single ? _eass_format_float(body, (float)magnitude) : _eass_format_double(body, magnitude);
+    } else {
+        int precision = spec->precision >= 0 ? spec->precision : 6;
+        int percent = (type == '%');
+        if (percent) {
+            magnitude *= 100;
+            type = 'f';
+        }
+        if ((type == 'f' || type == 'F') && precision <= 19) {
+            // Exact fast path on the binary value
+            uint64_t mantissa;
+            int exponent;
+            if (single && !percent) {
+                float f = (float)magnitude;
+                uint32_t bits;
+                memcpy(&bits, &f, sizeof(bits));
+                uint32_t biased = (bits >> 23) & 0xff;
+                mantissa = bits & 0x7fffff;
+                exponent = biased ? (int)biased - 150 : -149;
+                if (biased) mantissa |= 0x800000;
+            } else {
+                uint64_t bits;
+                memcpy(&bits, &magnitude, sizeof(bits));
+                uint32_t biased = (uint32_t)(bits >> 52) & 0x7ff;
+                mantissa = bits & 0xfffffffffffffu;
+                exponent = biased ? (int)biased - 1075 : -1074;
+                if (biased) mantissa |= (uint64_t)1 << 52;
+            }
+            len = _eass_format_fixed(body, mantissa, exponent, precision);
+        }
+        if (len == 0) {
+            char conversion[6] = "%.*f";
+            char* c = conversion + 1;
+            if (spec->alternate) *c++ = '#';
+            *c++ = '.';
+            *c++ = '*';
+            *c++ = type ? type : 'g';
+            *c = '\0';
+            int needed = snprintf(body, sizeof(stack_body), conversion, precision, magnitude);
+            if (needed < 0) {
+                needed = 0;
+            } else if ((size_t)needed >= sizeof(stack_body)) {
+                body = (char*)malloc((size_t)needed + 2); // Room for a '%' after the digits
+                if (!body) {
+                    _set_error(ENOMEM, "malloc failed in format specification");
+                    sink->error = 1;
+                    return;
+                }
+                snprintf(body, (size_t)needed + 1, conversion, precision, magnitude);
+            }
+            len = (size_t)needed;
+            // The output must not depend on the locale's decimal point
+            for (size_t i = 0; i < len; i++) {
+                if (!((body[i] >= '0' && body[i] <= '9') || body[i] == 'e' || body[i] == 'E' ||
+                      body[i] == '+' || body[i] == '-')) {
+                    body[i] = '.';
+                }
+            }
+        }
+        if (percent) {
+            body[len++] = '%'; // Both buffers keep a byte past the digits, see above
+        }
+    }
+    char sign = _eass_spec_sign(spec, negative);
+    prefix[0] = sign;
+    _eass_spec_pad(sink, spec, prefix, sign ? 1 : 0, body, len, 1);
+    if (body != stack_body) {
+        free(body);
+    }
+}
+
+static void _eass_spec_integer(EassSink* sink, const EassFormatSpec* spec, unsigned long long magnitude, int negative) {
+    char prefix[3];
+    char body[72];
+    size_t prefix_len = 0;
+    size_t len = 0;
+    unsigned base = 10;
+    const char* digits = "0123456789abcdef";
+    switch (spec->type) {
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case '%': {
+            double value = (double)magnitude;
+            _eass_spec_float(sink, spec, negative ? -value : value, 0);
+            return;
+        }
+        case 'c':
+            body[0] = (char)magnitude;
+            _eass_spec_text(sink, spec, body, 1);
+            return;
+        case 'x': base = 16; break;
+        case 'X': base = 16; digits = "0123456789ABCDEF"; break;
+        case 'o': base = 8; break;
+        case 'b': base = 2; break;
+        default: break;
+    }
+    char sign = _eass_spec_sign(spec, negative);
+    if (sign) prefix[prefix_len++] = sign;
+    if (spec->alternate && base != 10) {
+        prefix[prefix_len++] = '0';
+        prefix[prefix_len++] = (base == 16) ? spec->type : (base == 8) ? 'o' : 'b';
+    }
+    if (base == 10) {
+        len = _eass_format_uint64(body, magnitude);
+    } else {
+        char* end = body + sizeof(body);
+        char* p = end;
+        do {
+            *--p = digits[magnitude % base];
+            magnitude /= base;
+        } while (magnitude != 0);
+        len = (size_t)(end - p);
+        memmove(body, p, len);
+    }
+    _eass_spec_pad(sink, spec, prefix, prefix_len, body, len, 1);
+}
+
+// Internal function to write a value under a specification; returns -1 for an error value
+static int _eass_sink_spec_value(EassSink* sink, const EassFormatSpec* spec, const DynamicValue* val) {
+    if (val->error) {
+        return -1;
+    }
+    switch (val->type) {
+        case EASS_INT: {
+            long long i = val->value.i;
+            _eass_spec_integer(sink, spec, i < 0 ? 0ull - (unsigned long long)i : (unsigned long long)i, i < 0);
+            return 0;
+        }
+        case EASS_FLOAT:
+            _eass_spec_float(sink, spec, val->value.f, 1);
+            return 0;
+        case EASS_STRING:
+            if (string_value(val)) {
+                _eass_spec_text(sink, spec, string_value(val), strlen(string_value(val)));
+                return 0;
+            }
+            break;
+        case EASS_STRVIEW:
+            _eass_spec_text(sink, spec, EASS_VIEW_DATA(*val), EASS_VIEW_LENGTH(*val));
+            return 0;
+        default:
+            break;
+    }
+    // Arrays and NULL are padded as the text print() shows for them
+    EassStr text = eass_str();
+    EassSink inner = eass_sink_str(&text);
+    int result = _eass_sink_value(&inner, val);
+    if (result == 0) {
+        _eass_spec_text(sink, spec, eass_str_cstr(&text), text.size);
+    }
+    eass_str_free(&text);
+    return result;
+}
+
+// Internal function to write the value of a placeholder, with its specification if it has one
+static int _eass_sink_op_value(EassSink* sink, const EassFormatOp* op, const DynamicValue* val) {
+    return op->has_spec ? _eass_sink_spec_value(sink, &op->spec, val) : _eass_sink_value(sink, val);
+}
+
+// Internal function to read the arguments of string_format() and its variants into a table,
+// using stack_values when they fit. The call passes as many arguments as there are "{}" slots
+// or as the highest "{N}" index needs, whichever is more, and every one is read exactly once.
+static DynamicValue* _eass_string_args(const EassFormat* fmt, va_list args, DynamicValue* stack_values, size_t* count) {
+    size_t arg_count = _eass_format_arg_count(fmt);
+    DynamicValue* values = stack_values;
+    if (arg_count > EASS_FORMAT_STACK_ARGS) {
+        values = (DynamicValue*)malloc(sizeof(DynamicValue) * arg_count);
+        if (!values) {
+            _set_error(ENOMEM, "malloc failed in string_format");
+            // The arguments belong to the call even when it fails
+            for (size_t i = 0; i < arg_count; i++) {
+                DynamicValue val = va_arg(args, DynamicValue);
+                free_dynamic_value(&val);
+            }
+            return NULL;
+        }
+    }
+    for (size_t i = 0; i < arg_count; i++) {
+        values[i] = va_arg(args, DynamicValue);
+    }
+    *count = arg_count;
+    return values;
+}
+
+// Internal function to free the table from _eass_string_args() and the values in it
+static void _eass_string_args_free(DynamicValue* values, size_t count, DynamicValue* stack_values) {
+    for (size_t i = 0; i < count; i++) {
+        free_dynamic_value(&values[i]);
+    }
+    if (values != stack_values) {
+        free(values);
+    }
+}
+
+// Internal function to print one line whose template has "{N}" placeholders: the arguments are
+// read into a table once, so an index can be used any number of times
+static void _eass_vprint_indexed(EassSink* sink, const EassFormat* fmt, va_list args) {
+    DynamicValue stack_values[EASS_FORMAT_STACK_ARGS];
+    size_t count;
+    DynamicValue* values = _eass_string_args(fmt, args, stack_values, &count);
+    if (!values) {
+        return;
+    }
+    size_t current_arg = 0;
+    int failed = 0;
+    for (size_t op = 0; op < fmt->op_count && !failed; op++) {
+        const EassFormatOp* current = &fmt->ops[op];
+        if (current->kind == EASS_OP_LITERAL) {
+            _eass_sink_write(sink, fmt->text + current->offset, current->length);
+            continue;
+        }
+        size_t index = (current->kind == EASS_OP_NEXT_ARG) ? current_arg++ : (size_t)current->index;
+        failed = _eass_sink_op_value(sink, current, &values[index]) != 0;
+    }
+    if (failed) {
+        const EassError* error = eass_get_last_error();
+        _eass_sink_printf(sink, "Error: %d - %s", error->code, error->message);
+    } else {
+        _eass_sink_write(sink, "\n", 1);
+    }
+    _eass_string_args_free(values, count, stack_values);
+}
+
+// Internal function behind print() and its variants: writes one line to a sink and frees the arguments
+static void _eass_vprint(EassSink* sink, const EassFormat* fmt, va_list args) {
+    if (fmt->max_index >= 0) {
+        _eass_vprint_indexed(sink, fmt, args);
+        return;
+    }
+    for (size_t op = 0; op < fmt->op_count; op++) {
+        const EassFormatOp* current = &fmt->ops[op];
+        if (current->kind == EASS_OP_LITERAL) {
+            _eass_sink_write(sink, fmt->text + current->offset, current->length);
+            continue;
+        }
+
+        // Get the argument as a DynamicValue
+        DynamicValue val = va_arg(args, DynamicValue);
+        if (_eass_sink_op_value(sink, current, &val) != 0) {
+            const EassError* error = eass_get_last_error();
+            _eass_sink_printf(sink, "Error: %d - %s", error->code, error->message);
+            return; // Exit the function on error
+        }
+        free_dynamic_value(&val); // Clean up the DynamicValue
+    }
+    _eass_sink_write(sink, "\n", 1);
+}
+
+// Internal function to print one line to any sink; files and descriptors get one write per line
+static void _eass_vprint_sink(EassSink* sink, const EassFormat* fmt, va_list args) {
+    if ((sink->kind == EASS_SINK_FILE || sink->kind == EASS_SINK_FD) && sink->data == NULL) {
+        char stage[EASS_SINK_STAGE_SIZE];
+        sink->data = stage;
+        sink->capacity = sizeof(stage);
+        _eass_vprint(sink, fmt, args);
+        eass_sink_flush(sink);
+        sink->data = NULL;
+        sink->capacity = 0;
+        return;
+    }
+    _eass_vprint(sink, fmt, args);
+    _eass_sink_terminate(sink);
+}
+
+// Internal function to write a packed argument to a sink; returns -1 for an error value
+static int _eass_sink_arg(EassSink* sink, const EassArg* arg) {
+    char number[32];
+    switch (arg->type) {
+        case EASS_ARG_INT:
+            _eass_sink_write(sink, number, _eass_format_int64(number, arg->as.i));
+            break;
+        case EASS_ARG_UINT:
+            _eass_sink_write(sink, number, _eass_format_uint64(number, arg->as.u));
+            break;
+        case EASS_ARG_FLOAT:
+            _eass_sink_write(sink, number, _eass_format_float(number, arg->as.f));
+            break;
+        case EASS_ARG_DOUBLE:
+            _eass_sink_write(sink, number, _eass_format_double(number, arg->as.d));
+            break;
+        case EASS_ARG_STRING:
+        case EASS_ARG_INLINE: {
+            const char* text = _eass_arg_text(arg);
+            if (text)
+                _eass_sink_write(sink, text, strlen(text));
+            else
+                _eass_sink_write(sink, "NULL", 4);
+            break;
+        }
+        case EASS_ARG_VIEW:
+            _eass_sink_write(sink, arg->as.sv.data, arg->as.sv.length);
+            break;
+        case EASS_ARG_ARRAY:
+            return _eass_sink_elements(sink, arg->as.a.data, arg->as.a.size, arg->as.a.storage);
+        case EASS_ARG_VALUE:
+            return _eass_sink_value(sink, arg->as.v);
+    }
+    return 0;
+}
+
+// Internal function to write a packed argument under a specification; returns -1 for an error value
+static int _eass_sink_spec_arg(EassSink* sink, const EassFormatSpec* spec, const EassArg* arg) {
+    switch (arg->type) {
+        case EASS_ARG_INT: {
+            long long i = arg->as.i;
+            _eass_spec_integer(sink, spec, i < 0 ? 0ull - (unsigned long long)i : (unsigned long long)i, i < 0);
+            return 0;
+        }
+        case EASS_ARG_UINT:
+            _eass_spec_integer(sink, spec, arg->as.u, 0);
+            return 0;
+        case EASS_ARG_FLOAT:
+            _eass_spec_float(sink, spec, arg->as.f, 1);
+            return 0;
+        case EASS_ARG_DOUBLE:
+            _eass_spec_float(sink, spec, arg->as.d, 0);
+            return 0;
+        case EASS_ARG_STRING:
+        case EASS_ARG_INLINE: {
+            const char* text = _eass_arg_text(arg);
+            _eass_spec_text(sink, spec, text ? text : "NULL", text ? strlen(text) : 4);
+            return 0;
+        }
+        case EASS_ARG_VIEW:
+            _eass_spec_text(sink, spec, arg->as.sv.data, arg->as.sv.length);
+            return 0;
+        case EASS_ARG_VALUE:
+            return _eass_sink_spec_value(sink, spec, arg->as.v);
+        default: {
+            EassStr text = eass_str();
+            EassSink inner = eass_sink_str(&text);
+            int result = _eass_sink_arg(&inner, arg);
+            if (result == 0) {
+                _eass_spec_text(sink, spec, eass_str_cstr(&text), text.size);
+            }
+            eass_str_free(&text);
+            return result;
+        }
+    }
+}
+
+// Internal function to write a template filled from packed arguments; "{}" takes the next
+// argument and "{N}" takes argument N, or is copied as text when not positional (as print()
+// did before it supported indices, for older binary logs). Returns -1 for an error value.
+static int _eass_vformat_args(EassSink* sink, const EassFormat* fmt, const EassArg* args, size_t count, int positional) {
+    static const EassArg missing = {EASS_ARG_VALUE, {.v = &_eass_null_value}};
+    size_t next = 0;
+    for (size_t op = 0; op < fmt->op_count; op++) {
+        const EassFormatOp* current = &fmt->ops[op];
+        size_t index;
+        if (current->kind == EASS_OP_LITERAL || (current->kind == EASS_OP_INDEXED_ARG && !positional)) {
+            _eass_sink_write(sink, fmt->text + current->offset, current->length);
+            continue;
+        }
+        index = (current->kind == EASS_OP_NEXT_ARG) ? next++ : (size_t)current->index;
+        const EassArg* arg = index < count ? &args[index] : &missing;
+        if ((current->has_spec ? _eass_sink_spec_arg(sink, &current->spec, arg) : _eass_sink_arg(sink, arg)) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Internal function to print one line of packed arguments to a sink
+static void _eass_vprint_args(EassSink* sink, const EassFormat* fmt, const EassArg* args, size_t count, int positional) {
+    if (_eass_vformat_args(sink, fmt, args, count, positional) != 0) {
+        const EassError* error = eass_get_last_error();
+        _eass_sink_printf(sink, "Error: %d - %s", error->code, error->message);
+        return;
+    }
+    _eass_sink_write(sink, "\n", 1);
+}
+
+#ifdef EASS_HAS_ASYNC
+// One slot of the asynchronous print() queue
+typedef struct {
+    atomic_size_t sequence; // Position the slot is ready for; position + 1 once it holds text
+    size_t length;
+    char text[EASS_ASYNC_SLOT_SIZE - 2 * sizeof(size_t)];
+} EassAsyncSlot;
+
+// Bounded multi-producer, single-consumer ring of text slots (after D. Vyukov's bounded queue).
+// A line is stored in consecutive slots claimed with one compare-and-swap, so the background
+// thread writes it out whole even when several threads print at once.
+typedef struct {
+    EassAsyncSlot* slots;
+    size_t mask;                  // Number of slots - 1
+    EassAsyncPolicy policy;
+    thrd_t thread;
+    char pad0[64];
+    atomic_size_t enqueue_pos;    // Shared by the producers
+    char pad1[64];
+    size_t dequeue_pos;           // Owned by the background thread
+    atomic_size_t written;        // Lines before this position have been handed to the OS
+    atomic_size_t drain_target;   // Highest position a _eass_async_drain() call is waiting for
+    atomic_int running;
+    atomic_int producers;         // Threads currently inside _eass_async_push()
+    atomic_int sleeping;          // Set while the background thread waits on wakeup
+    atomic_int waiting;           // Threads waiting on progress for free slots or a drain
+    atomic_size_t dropped;
+    mtx_t wait_lock;
+    cnd_t wakeup;                 // Signalled when a line arrives while the thread sleeps
+    cnd_t progress;               // Signalled when the thread frees slots or writes lines out
+} EassAsyncQueue;
+
+static EassAsyncQueue _eass_async;
+static atomic_int _eass_async_enabled;
+static int _eass_async_atexit_registered = 0;
+static EASS_THREAD_LOCAL EassStr _eass_async_line;
+static EASS_THREAD_LOCAL EassSink _eass_async_scratch;
+static once_flag _eass_async_once = ONCE_FLAG_INIT;
+static tss_t _eass_async_line_key;
+
+// Internal function to free a thread's line builder when the thread exits
+static void _eass_async_thread_exit(void* line) {
+    eass_str_free((EassStr*)line);
+}
+
+static void _eass_async_init(void) {
+    mtx_init(&_eass_async.wait_lock, mtx_plain);
+    cnd_init(&_eass_async.wakeup);
+    cnd_init(&_eass_async.progress);
+    tss_create(&_eass_async_line_key, _eass_async_thread_exit);
+}
+
+// Internal function to wake the background thread if it is waiting for lines
+static void _eass_async_wake(void) {
+    // Pairs with the fence in _eass_async_consumer(): either it sees the new line or we see it asleep
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&_eass_async.sleeping, memory_order_relaxed)) {
+        mtx_lock(&_eass_async.wait_lock);
+        cnd_signal(&_eass_async.wakeup);
+        mtx_unlock(&_eass_async.wait_lock);
+    }
+}
+
+// Internal function to wake threads waiting for free slots or for a drain, if there are any
+static void _eass_async_notify(void) {
+    // Pairs with the increment in _eass_async_wait(): either it sees our progress or we see it waiting
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&_eass_async.waiting, memory_order_relaxed)) {
+        mtx_lock(&_eass_async.wait_lock);
+        cnd_broadcast(&_eass_async.progress);
+        mtx_unlock(&_eass_async.wait_lock);
+    }
+}
+
+// Internal function to sleep until the background thread makes progress, unless done() is already
+// true once this thread is counted as waiting
+static void _eass_async_wait(int (*done)(size_t), size_t arg) {
+    mtx_lock(&_eass_async.wait_lock);
+    atomic_fetch_add_explicit(&_eass_async.waiting, 1, memory_order_seq_cst);
+    if (!done(arg)) {
+        cnd_wait(&_eass_async.progress, &_eass_async.wait_lock);
+    }
+    atomic_fetch_sub_explicit(&_eass_async.waiting, 1, memory_order_relaxed);
+    mtx_unlock(&_eass_async.wait_lock);
+}
+
+// Background thread: copies lines from the queue to standard output in large writes
+static int _eass_async_consumer(void* arg) {
+    (void)arg;
+    EassSink out = _eass_stdout_target();
+    out.capacity = 64 * 1024;
+    out.data = (char*)malloc(out.capacity);
+    if (!out.data) {
+        out.capacity = 0;
+    }
+    unsigned idle = 0;
+    for (;;) {
+        EassAsyncSlot* slot = &_eass_async.slots[_eass_async.dequeue_pos & _eass_async.mask];
+        size_t seq = atomic_load_explicit(&slot->sequence, memory_order_acquire);
+        if (seq == _eass_async.dequeue_pos + 1) {
+            _eass_sink_write(&out, slot->text, slot->length);
+            atomic_store_explicit(&slot->sequence, _eass_async.dequeue_pos + _eass_async.mask + 1, memory_order_release);
+            _eass_async.dequeue_pos++;
+            idle = 0;
+            // A drain may have published its target after we passed it, so compare with >=
+            size_t target = atomic_load_explicit(&_eass_async.drain_target, memory_order_acquire);
+            if (_eass_async.dequeue_pos >= target &&
+                atomic_load_explicit(&_eass_async.written, memory_order_relaxed) < target) {
+                eass_sink_flush(&out); // input() is waiting for this line
+                atomic_store_explicit(&_eass_async.written, _eass_async.dequeue_pos, memory_order_release);
+            }
+            _eass_async_notify();
+            continue;
+        }
+        // Queue is empty: hand what we have to the OS, then stop or wait for more
+        eass_sink_flush(&out);
+        atomic_store_explicit(&_eass_async.written, _eass_async.dequeue_pos, memory_order_release);
+        _eass_async_notify();
+        if (!atomic_load_explicit(&_eass_async.running, memory_order_acquire)) {
+            break;
+        }
+        if (++idle < 64) {
+            thrd_yield(); // A burst of lines often follows shortly
+            continue;
+        }
+        mtx_lock(&_eass_async.wait_lock);
+        atomic_store_explicit(&_eass_async.sleeping, 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        // Check again now that producers can see we are going to sleep
+        if (atomic_load_explicit(&slot->sequence, memory_order_acquire) != _eass_async.dequeue_pos + 1 &&
+            atomic_load_explicit(&_eass_async.running, memory_order_acquire)) {
+            cnd_wait(&_eass_async.wakeup, &_eass_async.wait_lock);
+        }
+        atomic_store_explicit(&_eass_async.sleeping, 0, memory_order_relaxed);
+        mtx_unlock(&_eass_async.wait_lock);
+        idle = 0;
+    }
+    free(out.data);
+    return 0;
+}
+
+// Internal function to check whether the background thread has freed the slot before position + 1
+static int _eass_async_slot_free(size_t position) {
+    EassAsyncSlot* slot = &_eass_async.slots[position & _eass_async.mask];
+    return (intptr_t)atomic_load_explicit(&slot->sequence, memory_order_acquire) - (intptr_t)position >= 0;
+}
+
+// Internal function to copy a formatted line into the queue; returns -1 if it was dropped
+static int _eass_async_push(const char* text, size_t len) {
+    const size_t payload = sizeof(((EassAsyncSlot*)0)->text);
+    size_t count = len == 0 ? 1 : (len + payload - 1) / payload;
+    int truncated = count > _eass_async.mask + 1;
+    if (truncated) {
+        count = _eass_async.mask + 1; // Longer than the whole queue: keep what fits
+        len = count * payload;
+    }
+
+    size_t pos = atomic_load_explicit(&_eass_async.enqueue_pos, memory_order_relaxed);
+    for (;;) {
+        // Slots are released in order, so if the last one is free all of them are
+        EassAsyncSlot* last = &_eass_async.slots[(pos + count - 1) & _eass_async.mask];
+        size_t seq = atomic_load_explicit(&last->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + count - 1);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&_eass_async.enqueue_pos, &pos, pos + count,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            if (_eass_async.policy == EASS_ASYNC_DROP) {
+                atomic_fetch_add_explicit(&_eass_async.dropped, 1, memory_order_relaxed);
+                return -1;
+            }
+            _eass_async_wait(_eass_async_slot_free, pos + count - 1); // Queue is full
+            pos = atomic_load_explicit(&_eass_async.enqueue_pos, memory_order_relaxed);
+        } else {
+            pos = atomic_load_explicit(&_eass_async.enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        EassAsyncSlot* slot = &_eass_async.slots[(pos + i) & _eass_async.mask];
+        size_t chunk = len > payload ? payload : len;
+        memcpy(slot->text, text, chunk);
+        slot->length = chunk;
+        text += chunk;
+        len -= chunk;
+        if (truncated && len == 0) {
+            slot->text[chunk - 1] = '\n'; // Still end the line
+        }
+        atomic_store_explicit(&slot->sequence, pos + i + 1, memory_order_release);
+    }
+    _eass_async_wake();
+    return 0;
+}
+
+// Internal function to check whether a drain up to target is over
+static int _eass_async_drained(size_t target) {
+    return atomic_load_explicit(&_eass_async.written, memory_order_acquire) >= target ||
+           !atomic_load_explicit(&_eass_async_enabled, memory_order_acquire);
+}
+
+// Internal function to wait until every line queued so far has been handed to the OS
+static void _eass_async_drain(void) {
+    if (!atomic_load_explicit(&_eass_async_enabled, memory_order_acquire)) {
+        return;
+    }
+    size_t target = atomic_load_explicit(&_eass_async.enqueue_pos, memory_order_acquire);
+    // Only ever raise the target, so that concurrent drains all get theirs
+    size_t current = atomic_load_explicit(&_eass_async.drain_target, memory_order_relaxed);
+    while (current < target && !atomic_compare_exchange_weak_explicit(&_eass_async.drain_target, &current, target,
+                                                                      memory_order_release, memory_order_relaxed)) {
+    }
+    _eass_async_wake();
+    while (!_eass_async_drained(target)) {
+        _eass_async_wait(_eass_async_drained, target);
+    }
+}
+
+// Internal function to start queueing one line. Returns the per-thread scratch sink to format
+// it into, or NULL if async mode is off; a non-NULL result must be passed to _eass_async_end().
+static EassSink* _eass_async_begin(void) {
+    if (!atomic_load_explicit(&_eass_async_enabled, memory_order_relaxed)) {
+        return NULL;
+    }
+    // seq_cst on both sides: eass_async_stop() clears the flag and then reads the count, we bump
+    // the count and then read the flag, so at least one of us sees the other
+    atomic_fetch_add_explicit(&_eass_async.producers, 1, memory_order_seq_cst);
+    if (!atomic_load_explicit(&_eass_async_enabled, memory_order_seq_cst)) {
+        atomic_fetch_sub_explicit(&_eass_async.producers, 1, memory_order_release);
+        return NULL;
+    }
+    // The line builder keeps its storage from call to call and is freed when the thread exits
+    if (_eass_async_scratch.kind != EASS_SINK_STRING) {
+        _eass_async_scratch = eass_sink_str(&_eass_async_line);
+        tss_set(_eass_async_line_key, &_eass_async_line);
+    }
+    eass_str_clear(&_eass_async_line);
+    _eass_async_scratch.error = 0;
+    return &_eass_async_scratch;
+}
+
+// Internal function to queue the line formatted into the scratch sink
+static void _eass_async_end(EassSink* scratch) {
+    if (!scratch->error) {
+        _eass_async_push(eass_str_cstr(scratch->str), scratch->str->size);
+    }
+    atomic_fetch_sub_explicit(&_eass_async.producers, 1, memory_order_release);
+}
+
+// Function to move the I/O of print() to a background thread. capacity is the number of
+// EASS_ASYNC_SLOT_SIZE-byte slots in the queue (rounded up to a power of two).
+int eass_async_start(size_t capacity, EassAsyncPolicy policy) {
+    if (atomic_load(&_eass_async_enabled)) {
+        _set_error(EINVAL, "eass_async_start called while async mode is running");
+        return -1;
+    }
+    call_once(&_eass_async_once, _eass_async_init);
+    size_t slots = 2;
+    while (slots < capacity) slots <<= 1;
+    _eass_async.slots = (EassAsyncSlot*)malloc(slots * sizeof(EassAsyncSlot));
+    if (!_eass_async.slots) {
+        _set_error(ENOMEM, "malloc failed in eass_async_start");
+        return -1;
+    }
+    for (size_t i = 0; i < slots; i++) {
+        atomic_init(&_eass_async.slots[i].sequence, i);
+    }
+    _eass_async.mask = slots - 1;
+    _eass_async.policy = policy;
+    _eass_async.dequeue_pos = 0;
+    atomic_store(&_eass_async.written, 0);
+    atomic_store(&_eass_async.drain_target, 0);
+    atomic_store(&_eass_async.sleeping, 0);
+    atomic_store(&_eass_async.waiting, 0);
+    atomic_store(&_eass_async.enqueue_pos, 0);
+    atomic_store(&_eass_async.dropped, 0);
+    atomic_store(&_eass_async.running, 1);
+
+    eass_flush(); // Earlier output must come first
+    if (thrd_create(&_eass_async.thread, _eass_async_consumer, NULL) != thrd_success) {
+        _set_error(EAGAIN, "thrd_create failed in eass_async_start");
+        free(_eass_async.slots);
+        _eass_async.slots = NULL;
+        return -1;
+    }
+    if (!_eass_async_atexit_registered) {
+        _eass_async_atexit_registered = 1;
+        atexit(eass_async_stop); // Drain the queue when the program exits
+    }
+    atomic_store(&_eass_async_enabled, 1);
+    return 0;
+}
+
+// Function to write out everything still queued and return print() to synchronous mode
+void eass_async_stop(void) {
+    if (!atomic_exchange(&_eass_async_enabled, 0)) {
+        return;
+    }
+    // Let threads that are already queueing a line finish
+    while (atomic_load(&_eass_async.producers) != 0) {
+        thrd_yield();
+    }
+    atomic_store(&_eass_async.running, 0);
+    mtx_lock(&_eass_async.wait_lock);
+    cnd_signal(&_eass_async.wakeup);
+    mtx_unlock(&_eass_async.wait_lock);
+    thrd_join(_eass_async.thread, NULL);
+    mtx_lock(&_eass_async.wait_lock);
+    cnd_broadcast(&_eass_async.progress); // Drains waiting in other threads see that async mode is off
+    mtx_unlock(&_eass_async.wait_lock);
+    free(_eass_async.slots);
+    _eass_async.slots = NULL;
+}
+
+// Function to get the number of lines discarded because the queue was full
+size_t eass_async_dropped(void) {
+    return atomic_load(&_eass_async.dropped);
+}
+#endif // EASS_HAS_ASYNC
+
+// Internal function behind print() and print_compiled()
+static void _eass_print_line(const EassFormat* fmt, va_list args) {
+#ifdef EASS_HAS_ASYNC
+    EassSink* scratch = _eass_async_begin();
+    if (scratch) {
+        _eass_vprint(scratch, fmt, args);
+        _eass_async_end(scratch);
+        return;
+    }
+#endif
+    _eass_vprint(_eass_stdout_sink(), fmt, args);
+    if (_eass_flush_policy == EASS_FLUSH_LINE) {
+        eass_flush();
+    }
+}
+
+// Function to print values to the console
+void print(const char* format, ...) {
+    const EassFormat* fmt = _eass_format_lookup(format);
+    if (!fmt) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    _eass_print_line(fmt, args);
+    va_end(args);
+}
+
+// Function to print values to the console with a template from eass_format_compile()
+void print_compiled(const EassFormat* fmt, ...) {
+    if (fmt == NULL) {
+        _set_error(EINVAL, "print_compiled called with NULL template");
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    _eass_print_line(fmt, args);
+    va_end(args);
+}
+
+// Function to print values to a stdio stream
+void print_to(FILE* file, const char* format, ...) {
+    if (file == NULL) {
+        _set_error(EINVAL, "print_to called with NULL file");
+        return;
+    }
+    const EassFormat* fmt = _eass_format_lookup(format);
+    if (!fmt) {
+        return;
+    }
+    EassSink sink = eass_sink_file(file);
+    va_list args;
+    va_start(args, format);
+    _eass_vprint_sink(&sink, fmt, args);
+    va_end(args);
+}
+
+// Function to print values to a file descriptor such as a socket or an open file
+void print_fd(int fd, const char* format, ...) {
+    const EassFormat* fmt = _eass_format_lookup(format);
+    if (!fmt) {
+        return;
+    }
+    EassSink sink = eass_sink_fd(fd);
+    va_list args;
+    va_start(args, format);
+    _eass_vprint_sink(&sink, fmt, args);
+    va_end(args);
+}
+
+// Function to print values into a caller buffer. Like snprintf(), it returns the length the
+// full line would have had, so a result >= capacity means the output was truncated.
+size_t print_buf(char* buf, size_t capacity, const char* format, ...) {
+    const EassFormat* fmt = _eass_format_lookup(format);
+    if (!fmt) {
+        return 0;
+    }
+    EassSink sink = eass_sink_buffer(buf, capacity);
+    va_list args;
+    va_start(args, format);
+    _eass_vprint_sink(&sink, fmt, args);
+    va_end(args);
+    return sink.total;
+}
+
+// Function to print values to a sink created with one of the eass_sink_*() functions
+void print_sink(EassSink* sink, const char* format, ...) {
+    if (sink == NULL) {
+        _set_error(EINVAL, "print_sink called with NULL sink");
+        return;
+    }
+    const EassFormat* fmt = _eass_format_lookup(format);
+    if (!fmt) {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    _eass_vprint_sink(sink, fmt, args);
+    va_end(args);
+}
+
+// Function to print packed arguments; normally called through the print_typed() macro
+void print_args(const char* format, const EassArg* args, size_t count) {
+    const EassFormat* fmt = _eass_format_lookup(format);
+    if (!fmt) {
+        return;
+    }
+#ifdef EASS_HAS_ASYNC
+    EassSink* scratch = _eass_async_begin();
+    if (scratch) {
+        _eass_vprint_args(scratch, fmt, args, count, 1);
+        _eass_async_end(scratch);
+        return;
+    }
+#endif
+    _eass_vprint_args(_eass_stdout_sink(), fmt, args, count, 1);
+    if (_eass_flush_policy == EASS_FLUSH_LINE) {
+        eass_flush();
+    }
+}
+
+// Binary log record layout. Every value is written in the byte order of the machine that
+// logs; the header lets the decoder check that it matches.
+//   header:   "EASSBIN1", uint32 0x01020304
+//   'D' def:  uint32 id, uint32 length, template text
+//   'L' log:  uint8 positional, uint32 id, uint64 nanoseconds since open, uint32 count, values
+//   value:    uint8 EassType tag (or one of the extra tags below) followed by its payload
+#define EASS_BINLOG_MAGIC "EASSBIN1"
+#define EASS_BINLOG_BYTE_ORDER 0x01020304u
+#define EASS_BINLOG_TAG_ERROR 16  // uint32 code, uint32 length, message
+#define EASS_BINLOG_TAG_INT64 17
+#define EASS_BINLOG_TAG_UINT64 18
+#define EASS_BINLOG_TAG_DOUBLE 19
+#define EASS_BINLOG_MAX_DEPTH 64
+
+// State of the binary log shared by all threads
+typedef struct {
+    FILE* file;
+    uint64_t start;     // Clock reading when the log was opened
+    unsigned opened;    // Number of logs opened so far
+    unsigned file_generation; // Log that file belongs to; records of other logs are dropped
+#ifdef EASS_HAS_THREADS
+    atomic_uint generation; // Equal to opened while a log accepts records, 0 otherwise
+    atomic_uint next_id;
+    mtx_t lock;         // Guards file
+    mtx_t buffers_lock; // Guards buffers
+    struct EassBinlogBuffer* buffers; // Every thread's buffer, so that closing can flush them all
+    tss_t buffer_key;
+#else
+    unsigned generation;
+    unsigned next_id;
+#endif
+    int atexit_registered;
+} EassBinlog;
+
+// Records waiting to be written by one thread
+typedef struct EassBinlogBuffer {
+    unsigned generation; // Log these records belong to
+    size_t size;
+#ifdef EASS_HAS_THREADS
+    atomic_flag busy;    // Held by the owner while it adds a record and by eass_binlog_close()
+    struct EassBinlogBuffer* next;
+#endif
+    char data[EASS_BINLOG_BUFFER_SIZE];
+} EassBinlogBuffer;
+
+static EassBinlog _eass_binlog;
+
+#ifdef EASS_HAS_THREADS
+static once_flag _eass_binlog_once = ONCE_FLAG_INIT;
+static EASS_THREAD_LOCAL EassBinlogBuffer* _eass_binlog_local;
+
+static int _eass_binlog_flush_buffer(EassBinlogBuffer* buffer);
+
+// Internal function to take a buffer away from eass_binlog_close(), or from its owner
+static void _eass_binlog_claim(EassBinlogBuffer* buffer) {
+    while (atomic_flag_test_and_set_explicit(&buffer->busy, memory_order_acquire)) {
+        thrd_yield();
+    }
+}
+
+static void _eass_binlog_release(EassBinlogBuffer* buffer) {
+    atomic_flag_clear_explicit(&buffer->busy, memory_order_release);
+}
+
+// Internal function to write out and free a thread's buffer when the thread exits
+static void _eass_binlog_thread_exit(void* arg) {
+    EassBinlogBuffer* buffer = (EassBinlogBuffer*)arg;
+    _eass_binlog_claim(buffer);
+    _eass_binlog_flush_buffer(buffer);
+    _eass_binlog_release(buffer);
+    mtx_lock(&_eass_binlog.buffers_lock);
+    EassBinlogBuffer** link = &_eass_binlog.buffers;
+    while (*link != buffer) {
+        link = &(*link)->next;
+    }
+    *link = buffer->next;
+    mtx_unlock(&_eass_binlog.buffers_lock);
+    free(buffer);
+}
+
+static void _eass_binlog_init(void) {
+    mtx_init(&_eass_binlog.lock, mtx_plain);
+    mtx_init(&_eass_binlog.buffers_lock, mtx_plain);
+    tss_create(&_eass_binlog.buffer_key, _eass_binlog_thread_exit);
+}
+
+static unsigned _eass_binlog_generation(void) {
+    return atomic_load_explicit(&_eass_binlog.generation, memory_order_acquire);
+}
+
+static void _eass_binlog_lock(void) {
+    call_once(&_eass_binlog_once, _eass_binlog_init);
+    mtx_lock(&_eass_binlog.lock);
+}
+
+static void _eass_binlog_unlock(void) {
+    mtx_unlock(&_eass_binlog.lock);
+}
+
+// Internal function to get the calling thread's buffer, allocating it on first use
+static EassBinlogBuffer* _eass_binlog_buffer(void) {
+    if (_eass_binlog_local == NULL) {
+        EassBinlogBuffer* buffer = (EassBinlogBuffer*)malloc(sizeof(EassBinlogBuffer));
+        if (!buffer) {
+            _set_error(ENOMEM, "malloc failed in print_binlog");
+            return NULL;
+        }
+        buffer->generation = 0;
+        buffer->size = 0;
+        atomic_flag_clear(&buffer->busy);
+        call_once(&_eass_binlog_once, _eass_binlog_init);
+        mtx_lock(&_eass_binlog.buffers_lock);
+        buffer->next = _eass_binlog.buffers;
+        _eass_binlog.buffers = buffer;
+        mtx_unlock(&_eass_binlog.buffers_lock);
+        tss_set(_eass_binlog.buffer_key, buffer);
+        _eass_binlog_local = buffer;
+    }
+    return _eass_binlog_local;
+}
+#else
+static EassBinlogBuffer _eass_binlog_single;
+
+static unsigned _eass_binlog_generation(void) {
+    return _eass_binlog.generation;
+}
+
+static void _eass_binlog_lock(void) {
+}
+
+static void _eass_binlog_unlock(void) {
+}
+
+static void _eass_binlog_claim(EassBinlogBuffer* buffer) {
+    (void)buffer;
+}
+
+static void _eass_binlog_release(EassBinlogBuffer* buffer) {
+    (void)buffer;
+}
+
+static EassBinlogBuffer* _eass_binlog_buffer(void) {
+    return &_eass_binlog_single;
+}
+#endif
+
+// Internal function to read a monotonic clock in nanoseconds
+static uint64_t _eass_binlog_now(void) {
+#ifdef _WIN32
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000u +
+           (uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000u / (uint64_t)frequency.QuadPart;
+#elif defined(CLOCK_MONOTONIC)
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#elif __STDC_VERSION__ >= 201112L
+    // Strict C11 builds do not declare clock_gettime(); the wall clock will do
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#else
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (uint64_t)tv.tv_sec * 1000000000u + (uint64_t)tv.tv_usec * 1000u;
+#endif
+}
+
+// Internal function to append a block of records to the open log; returns -1 on failure
+static int _eass_binlog_write(unsigned generation, const char* data, size_t len) {
+    int result = 0;
+    _eass_binlog_lock();
+    // Records of a log that has since been closed are dropped
+    if (_eass_binlog.file && generation == _eass_binlog.file_generation) {
+        if (fwrite(data, 1, len, _eass_binlog.file) != len) {
+            _set_error(errno, "fwrite failed in binary log");
+            result = -1;
+        }
+    }
+    _eass_binlog_unlock();
+    return result;
+}
+
+// Internal function to hand a thread's buffered records to the log
+static int _eass_binlog_flush_buffer(EassBinlogBuffer* buffer) {
+    int result = 0;
+    if (buffer->size > 0) {
+        result = _eass_binlog_write(buffer->generation, buffer->data, buffer->size);
+        buffer->size = 0;
+    }
+    return result;
+}
+
+// Internal function to make room for a record of len bytes. Returns where to encode it, which
+// is a heap block stored in *heap when the record is larger than the whole buffer.
+static char* _eass_binlog_reserve(EassBinlogBuffer* buffer, size_t len, char** heap) {
+    *heap = NULL;
+    if (buffer->size + len > sizeof(buffer->data)) {
+        _eass_binlog_flush_buffer(buffer);
+        if (len > sizeof(buffer->data)) {
+            *heap = (char*)malloc(len);
+            if (!*heap) {
+                _set_error(ENOMEM, "malloc failed in print_binlog");
+            }
+            return *heap;
+        }
+    }
+    char* dest = buffer->data + buffer->size;
+    buffer->size += len;
+    return dest;
+}
+
+// Internal function to finish a record started with _eass_binlog_reserve()
+static void _eass_binlog_commit(EassBinlogBuffer* buffer, char* heap, size_t len) {
+    if (heap) {
+        _eass_binlog_write(buffer->generation, heap, len);
+        free(heap);
+    }
+}
+
+static char* _eass_binlog_put(char* dest, const void* src, size_t len) {
+    memcpy(dest, src, len);
+    return dest + len;
+}
+
+static char* _eass_binlog_put_u32(char* dest, uint32_t value) {
+    return _eass_binlog_put(dest, &value, sizeof(value));
+}
+
+// Internal function to get the encoded size of a DynamicValue
+static size_t _eass_binlog_value_size(const DynamicValue* val) {
+    if (val->error) {
+        return 9 + strlen(eass_get_last_error()->message);
+    }
+    switch (val->type) {
+        case EASS_INT:
+        case EASS_FLOAT:
+            return 5;
+        case EASS_STRING:
+            return string_value(val) ? 5 + strlen(string_value(val)) : 1;
+        case EASS_STRVIEW:
+            return 5 + EASS_VIEW_LENGTH(*val);
+        case EASS_ARRAY: {
+            size_t size = 5;
+            for (size_t i = 0; i < EASS_ARRAY_OF(*val)->size; i++) {
+                DynamicValue tmp;
+                size += _eass_binlog_value_size(_eass_element(EASS_ARRAY_OF(*val)->data, EASS_ARRAY_OF(*val)->storage, i, &tmp));
+            }
+            return size;
+        }
+        default:
+            return 1;
+    }
+}
+
+// Internal function to encode a DynamicValue; an error value records the current error
+static char* _eass_binlog_put_value(char* dest, const DynamicValue* val) {
+    if (val->error) {
+        const EassError* error = eass_get_last_error();
+        uint32_t length = (uint32_t)strlen(error->message);
+        *dest++ = EASS_BINLOG_TAG_ERROR;
+        dest = _eass_binlog_put_u32(dest, (uint32_t)error->code);
+        dest = _eass_binlog_put_u32(dest, length);
+        return _eass_binlog_put(dest, error->message, length);
+    }
+    switch (val->type) {
+        case EASS_INT:
+            *dest++ = EASS_INT;
+            return _eass_binlog_put(dest, &val->value.i, 4);
+        case EASS_FLOAT:
+            *dest++ = EASS_FLOAT;
+            return _eass_binlog_put(dest, &val->value.f, 4);
+        case EASS_STRING:
+            if (string_value(val)) {
+                uint32_t length = (uint32_t)strlen(string_value(val));
+                *dest++ = EASS_STRING;
+                dest = _eass_binlog_put_u32(dest, length);
+                return _eass_binlog_put(dest, string_value(val), length);
+            }
+            break;
+        case EASS_STRVIEW:
+            // Recorded as a string; the decoder never sees the borrowed buffer
+            *dest++ = EASS_STRING;
+            dest = _eass_binlog_put_u32(dest, (uint32_t)EASS_VIEW_LENGTH(*val));
+            return _eass_binlog_put(dest, EASS_VIEW_DATA(*val), EASS_VIEW_LENGTH(*val));
+        case EASS_ARRAY:
+            *dest++ = EASS_ARRAY;
+            dest = _eass_binlog_put_u32(dest, (uint32_t)EASS_ARRAY_OF(*val)->size);
+            for (size_t i = 0; i < EASS_ARRAY_OF(*val)->size; i++) {
+                DynamicValue tmp;
+                dest = _eass_binlog_put_value(dest, _eass_element(EASS_ARRAY_OF(*val)->data, EASS_ARRAY_OF(*val)->storage, i, &tmp));
+            }
+            return dest;
+        default:
+            break;
+    }
+    *dest++ = EASS_NULL;
+    return dest;
+}
+
+// Internal function to get the encoded size of a packed argument
+static size_t _eass_binlog_arg_size(const EassArg* arg) {
+    switch (arg->type) {
+        case EASS_ARG_FLOAT:
+            return 5;
+        case EASS_ARG_STRING:
+        case EASS_ARG_INLINE:
+            return _eass_arg_text(arg) ? 5 + strlen(_eass_arg_text(arg)) : 1;
+        case EASS_ARG_VIEW:
+            return 5 + arg->as.sv.length;
+        case EASS_ARG_ARRAY: {
+            size_t size = 5;
+            for (size_t i = 0; i < arg->as.a.size; i++) {
+                DynamicValue tmp;
+                size += _eass_binlog_value_size(_eass_element(arg->as.a.data, arg->as.a.storage, i, &tmp));
+            }
+            return size;
+        }
+        case EASS_ARG_VALUE:
+            return _eass_binlog_value_size(arg->as.v);
+        default:
+            return 9;
+    }
+}
+
+// Internal function to encode a packed argument
+static char* _eass_binlog_put_arg(char* dest, const EassArg* arg) {
+    switch (arg->type) {
+        case EASS_ARG_INT:
+            *dest++ = EASS_BINLOG_TAG_INT64;
+            return _eass_binlog_put(dest, &arg->as.i, 8);
+        case EASS_ARG_UINT:
+            *dest++ = EASS_BINLOG_TAG_UINT64;
+            return _eass_binlog_put(dest, &arg->as.u, 8);
+        case EASS_ARG_FLOAT:
+            *dest++ = EASS_FLOAT;
+            return _eass_binlog_put(dest, &arg->as.f, 4);
+        case EASS_ARG_DOUBLE:
+            *dest++ = EASS_BINLOG_TAG_DOUBLE;
+            return _eass_binlog_put(dest, &arg->as.d, 8);
+        case EASS_ARG_STRING:
+        case EASS_ARG_INLINE:
+            if (_eass_arg_text(arg)) {
+                uint32_t length = (uint32_t)strlen(_eass_arg_text(arg));
+                *dest++ = EASS_STRING;
+                dest = _eass_binlog_put_u32(dest, length);
+                return _eass_binlog_put(dest, _eass_arg_text(arg), length);
+            }
+            *dest++ = EASS_NULL;
+            return dest;
+        case EASS_ARG_VIEW:
+            *dest++ = EASS_STRING;
+            dest = _eass_binlog_put_u32(dest, (uint32_t)arg->as.sv.length);
+            return _eass_binlog_put(dest, arg->as.sv.data, arg->as.sv.length);
+        case EASS_ARG_ARRAY:
+            *dest++ = EASS_ARRAY;
+            dest = _eass_binlog_put_u32(dest, (uint32_t)arg->as.a.size);
+            for (size_t i = 0; i < arg->as.a.size; i++) {
+                DynamicValue tmp;
+                dest = _eass_binlog_put_value(dest, _eass_element(arg->as.a.data, arg->as.a.storage, i, &tmp));
+            }
+            return dest;
+        case EASS_ARG_VALUE:
+            return _eass_binlog_put_value(dest, arg->as.v);
+    }
+    return dest;
+}
+
+// Internal function to get and claim the calling thread's buffer for the open log, defining
+// the template in it first if this thread has not used it with this log. Returns NULL if no
+// log is open; otherwise the caller adds its record and calls _eass_binlog_release().
+static EassBinlogBuffer* _eass_binlog_prepare(EassFormat* fmt) {
+    if (_eass_binlog_generation() == 0) {
+        return NULL;
+    }
+    EassBinlogBuffer* buffer = _eass_binlog_buffer();
+    if (!buffer) {
+        return NULL;
+    }
+    _eass_binlog_claim(buffer);
+    unsigned generation = _eass_binlog_generation(); // The log may have closed meanwhile
+    if (generation == 0) {
+        _eass_binlog_release(buffer);
+        return NULL;
+    }
+    if (buffer->generation != generation) {
+        buffer->generation = generation;
+        buffer->size = 0;
+    }
+    if (fmt->binlog_generation != generation) {
+#ifdef EASS_HAS_THREADS
+        fmt->binlog_id = atomic_fetch_add_explicit(&_eass_binlog.next_id, 1, memory_order_relaxed);
+#else
+        fmt->binlog_id = _eass_binlog.next_id++;
+#endif
+        fmt->binlog_generation = generation;
+        size_t len = 9 + fmt->length;
+        char* heap;
+        char* dest = _eass_binlog_reserve(buffer, len, &heap);
+        if (!dest) {
+            fmt->binlog_generation = 0;
+            _eass_binlog_release(buffer);
+            return NULL;
+        }
+        *dest++ = 'D';
+        dest = _eass_binlog_put_u32(dest, fmt->binlog_id);
+        dest = _eass_binlog_put_u32(dest, (uint32_t)fmt->length);
+        _eass_binlog_put(dest, fmt->text, fmt->length);
+        _eass_binlog_commit(buffer, heap, len);
+    }
+    return buffer;
+}
+
+// Internal function to start a log record; the caller encodes count values after it
+static char* _eass_binlog_put_header(char* dest, const EassFormat* fmt, int positional, size_t count) {
+    uint64_t timestamp = _eass_binlog_now() - _eass_binlog.start;
+    *dest++ = 'L';
+    *dest++ = (char)positional;
+    dest = _eass_binlog_put_u32(dest, fmt->binlog_id);
+    dest = _eass_binlog_put(dest, &timestamp, sizeof(timestamp));
+    return _eass_binlog_put_u32(dest, (uint32_t)count);
+}
+
+// Function to start recording print_binlog() calls to a binary file
+int eass_binlog_open(const char* filename) {
+    if (filename == NULL) {
+        _set_error(EINVAL, "eass_binlog_open called with NULL filename");
+        return -1;
+    }
+    _eass_binlog_lock();
+    if (_eass_binlog.file) {
+        _eass_binlog_unlock();
+        _set_error(EINVAL, "eass_binlog_open called while a binary log is open");
+        return -1;
+    }
+    FILE* file = fopen(filename, "wb");
+    if (!file) {
+        _eass_binlog_unlock();
+        _set_error(errno, "fopen failed in eass_binlog_open");
+        return -1;
+    }
+    uint32_t byte_order = EASS_BINLOG_BYTE_ORDER;
+    fwrite(EASS_BINLOG_MAGIC, 1, 8, file);
+    fwrite(&byte_order, sizeof(byte_order), 1, file);
+    _eass_binlog.file = file;
+    _eass_binlog.start = _eass_binlog_now();
+    _eass_binlog.opened++;
+    _eass_binlog.file_generation = _eass_binlog.opened;
+#ifdef EASS_HAS_THREADS
+    atomic_store(&_eass_binlog.next_id, 1);
+    atomic_store(&_eass_binlog.generation, _eass_binlog.opened);
+#else
+    _eass_binlog.next_id = 1;
+    _eass_binlog.generation = _eass_binlog.opened;
+#endif
+    if (!_eass_binlog.atexit_registered) {
+        _eass_binlog.atexit_registered = 1;
+        atexit(eass_binlog_close); // Keep the main thread's last records
+    }
+    _eass_binlog_unlock();
+    return 0;
+}
+
+// Function to write the calling thread's buffered records to the binary log file
+int eass_binlog_flush(void) {
+    if (_eass_binlog_generation() == 0) {
+        return 0;
+    }
+    EassBinlogBuffer* buffer = _eass_binlog_buffer();
+    int result = -1;
+    if (buffer) {
+        _eass_binlog_claim(buffer);
+        result = _eass_binlog_flush_buffer(buffer);
+        _eass_binlog_release(buffer);
+    }
+    _eass_binlog_lock();
+    if (_eass_binlog.file && fflush(_eass_binlog.file) != 0) {
+        _set_error(errno, "fflush failed in eass_binlog_flush");
+        result = -1;
+    }
+    _eass_binlog_unlock();
+    return result;
+}
+
+// Function to write every thread's buffered records and close the binary log; records made
+// while it runs may be left out
+void eass_binlog_close(void) {
+    _eass_binlog_lock();
+    if (_eass_binlog_generation() == 0) {
+        _eass_binlog_unlock();
+        return;
+    }
+    // Refuse new records, then collect the ones already buffered
+#ifdef EASS_HAS_THREADS
+    atomic_store(&_eass_binlog.generation, 0);
+    _eass_binlog_unlock();
+    mtx_lock(&_eass_binlog.buffers_lock);
+    for (EassBinlogBuffer* buffer = _eass_binlog.buffers; buffer; buffer = buffer->next) {
+        _eass_binlog_claim(buffer); // Waits for a record the owner is still adding
+        _eass_binlog_flush_buffer(buffer);
+        _eass_binlog_release(buffer);
+    }
+    mtx_unlock(&_eass_binlog.buffers_lock);
+    _eass_binlog_lock();
+#else
+    _eass_binlog.generation = 0;
+    _eass_binlog_flush_buffer(_eass_binlog_buffer());
+#endif
+    if (_eass_binlog.file) {
+        fclose(_eass_binlog.file);
+        _eass_binlog.file = NULL;
+    }
+    _eass_binlog.file_generation = 0;
+    _eass_binlog_unlock();
+}
+
+// Function to record values for later formatting by eass_binlog_decode(); takes DynamicValue
+// arguments and frees them like print()
+void print_binlog(const char* format, ...) {
+    EassFormat* fmt = (EassFormat*)_eass_format_lookup(format);
+    if (!fmt) {
+        return;
+    }
+    size_t count = _eass_format_arg_count(fmt);
+    va_list args;
+    va_start(args, format);
+    EassBinlogBuffer* buffer = _eass_binlog_prepare(fmt);
+    if (buffer) {
+        va_list sizing;
+        va_copy(sizing, args);
+        size_t len = 18; // Record header
+        for (size_t i = 0; i < count; i++) {
+            DynamicValue val = va_arg(sizing, DynamicValue);
+            len += _eass_binlog_value_size(&val);
+        }
+        va_end(sizing);
+
+        char* heap;
+        char* dest = _eass_binlog_reserve(buffer, len, &heap);
+        if (dest) {
+            dest = _eass_binlog_put_header(dest, fmt, 1, count);
+            for (size_t i = 0; i < count; i++) {
+                DynamicValue val = va_arg(args, DynamicValue);
+                dest = _eass_binlog_put_value(dest, &val);
+                free_dynamic_value(&val);
+            }
+            _eass_binlog_commit(buffer, heap, len);
+            _eass_binlog_release(buffer);
+            va_end(args);
+            return;
+        }
+        _eass_binlog_release(buffer);
+    }
+    // Not recorded, but the arguments are still ours to free
+    for (size_t i = 0; i < count; i++) {
+        DynamicValue val = va_arg(args, DynamicValue);
+        free_dynamic_value(&val);
+    }
+    va_end(args);
+}
+
+// Function to record packed arguments; normally called through the print_binlog_typed() macro
+void print_binlog_args(const char* format, const EassArg* args, size_t count) {
+    EassFormat* fmt = (EassFormat*)_eass_format_lookup(format);
+    if (!fmt) {
+        return;
+    }
+    EassBinlogBuffer* buffer = _eass_binlog_prepare(fmt);
+    if (!buffer) {
+        return;
+    }
+    size_t len = 18; // Record header
+    for (size_t i = 0; i < count; i++) {
+        len += _eass_binlog_arg_size(&args[i]);
+    }
+    char* heap;
+    char* dest = _eass_binlog_reserve(buffer, len, &heap);
+    if (dest) {
+        dest = _eass_binlog_put_header(dest, fmt, 1, count);
+        for (size_t i = 0; i < count; i++) {
+            dest = _eass_binlog_put_arg(dest, &args[i]);
+        }
+        _eass_binlog_commit(buffer, heap, len);
+    }
+    _eass_binlog_release(buffer);
+}
+
+// Internal function to read exactly len bytes of a binary log; returns -1 if it ends early
+static int _eass_binlog_read(FILE* in, void* dest, size_t len) {
+    if (fread(dest, 1, len, in) != len) {
+        _set_error(EINVAL, "truncated binary log in eass_binlog_decode");
+        return -1;
+    }
+    return 0;
+}
+
+// Internal function to read a length-prefixed string into a new NUL-terminated block
+static char* _eass_binlog_read_string(FILE* in) {
+    uint32_t length;
+    if (_eass_binlog_read(in, &length, 4) != 0) {
+        return NULL;
+    }
+    char* text = (char*)malloc((size_t)length + 1);
+    if (!text) {
+        _set_error(ENOMEM, "malloc failed in eass_binlog_decode");
+        return NULL;
+    }
+    if (_eass_binlog_read(in, text, length) != 0) {
+        free(text);
+        return NULL;
+    }
+    text[length] = '\0';
+    return text;
+}
+
+// Internal function to decode a DynamicValue after its tag has been read. An error value
+// becomes the current error so that printing it reproduces the original message.
+static int _eass_binlog_read_value(FILE* in, int tag, DynamicValue* val, int depth) {
+    val->type = EASS_NULL;
+    val->error = 0;
+    val->flags = 0;
+    switch (tag) {
+        case EASS_INT:
+            val->type = EASS_INT;
+            return _eass_binlog_read(in, &val->value.i, 4);
+        case EASS_FLOAT:
+            val->type = EASS_FLOAT;
+            return _eass_binlog_read(in, &val->value.f, 4);
+        case EASS_STRING:
+            val->value.s = _eass_binlog_read_string(in);
+            if (!val->value.s) {
+                return -1;
+            }
+            val->type = EASS_STRING;
+            return 0;
+        case EASS_ARRAY: {
+            uint32_t size;
+            if (depth >= EASS_BINLOG_MAX_DEPTH || _eass_binlog_read(in, &size, 4) != 0) {
+                _set_error(EINVAL, "malformed array in eass_binlog_decode");
+                return -1;
+            }
+            DynamicArray arr = {{NULL}, 0, 0, 0, EASS_STORAGE_VALUES};
+            if (size > 0) {
+                arr.data = (DynamicValue*)malloc(size * sizeof(DynamicValue));
+                if (!arr.data) {
+                    _set_error(ENOMEM, "malloc failed in eass_binlog_decode");
+                    return -1;
+                }
+            }
+            arr.capacity = size;
+            *val = array_value(arr);
+            if (val->error) {
+                free(arr.data);
+                return -1;
+            }
+            for (uint32_t i = 0; i < size; i++) {
+                unsigned char element;
+                if (_eass_binlog_read(in, &element, 1) != 0 ||
+                    _eass_binlog_read_value(in, element, &EASS_ARRAY_OF(*val)->data[i], depth + 1) != 0) {
+                    return -1;
+                }
+                EASS_ARRAY_OF(*val)->size++;
+            }
+            return 0;
+        }
+        case EASS_NULL:
+            return 0;
+        case EASS_BINLOG_TAG_ERROR: {
+            uint32_t code;
+            if (_eass_binlog_read(in, &code, 4) != 0) {
+                return -1;
+            }
+            char* message = _eass_binlog_read_string(in);
+            if (!message) {
+                return -1;
+            }
+            _set_error((int)code, message);
+            free(message);
+            val->error = 1;
+            return 0;
+        }
+        default:
+            _set_error(EINVAL, "unknown value tag in eass_binlog_decode");
+            return -1;
+    }
+}
+
+// Internal function to decode one argument of a log record
+static int _eass_binlog_read_arg(FILE* in, EassArg* arg, DynamicValue* storage) {
+    unsigned char tag;
+    if (_eass_binlog_read(in, &tag, 1) != 0) {
+        return -1;
+    }
+    switch (tag) {
+        case EASS_BINLOG_TAG_INT64:
+            arg->type = EASS_ARG_INT;
+            return _eass_binlog_read(in, &arg->as.i, 8);
+        case EASS_BINLOG_TAG_UINT64:
+            arg->type = EASS_ARG_UINT;
+            return _eass_binlog_read(in, &arg->as.u, 8);
+        case EASS_BINLOG_TAG_DOUBLE:
+            arg->type = EASS_ARG_DOUBLE;
+            return _eass_binlog_read(in, &arg->as.d, 8);
+        default:
+            arg->type = EASS_ARG_VALUE;
+            arg->as.v = storage;
+            return _eass_binlog_read_value(in, tag, storage, 0);
+    }
+}
+
+// Function to turn a file written through eass_binlog_open() back into text, one line per
+// record prefixed with the seconds elapsed since the log was opened
+int eass_binlog_decode(FILE* in, FILE* out) {
+    char magic[8];
+    uint32_t byte_order;
+    if (in == NULL || out == NULL) {
+        _set_error(EINVAL, "eass_binlog_decode called with NULL stream");
+        return -1;
+    }
+    if (_eass_binlog_read(in, magic, 8) != 0 || memcmp(magic, EASS_BINLOG_MAGIC, 8) != 0 ||
+        _eass_binlog_read(in, &byte_order, 4) != 0 || byte_order != EASS_BINLOG_BYTE_ORDER) {
+        _set_error(EINVAL, "not a binary log from this machine in eass_binlog_decode");
+        return -1;
+    }
+
+    EassFormat** formats = NULL; // Templates indexed by id
+    size_t format_count = 0;
+    EassArg* args = NULL;
+    DynamicValue* values = NULL;
+    size_t arg_capacity = 0;
+    EassSink sink = eass_sink_file(out);
+    char stage[EASS_SINK_STAGE_SIZE];
+    sink.data = stage;
+    sink.capacity = sizeof(stage);
+    int result = 0;
+
+    for (;;) {
+        int kind = fgetc(in);
+        if (kind == EOF) {
+            break;
+        }
+        uint32_t id;
+        if (_eass_binlog_read(in, kind == 'L' ? (void*)magic : (void*)&id, kind == 'L' ? 1 : 4) != 0) {
+            result = -1;
+            break;
+        }
+        if (kind == 'D') {
+            char* text = _eass_binlog_read_string(in);
+            if (!text) {
+                result = -1;
+                break;
+            }
+            if (id >= format_count) {
+                size_t count = format_count ? format_count : 16;
+                while (count <= id) count *= 2;
+                EassFormat** grown = (EassFormat**)realloc(formats, count * sizeof(EassFormat*));
+                if (!grown) {
+                    free(text);
+                    _set_error(ENOMEM, "realloc failed in eass_binlog_decode");
+                    result = -1;
+                    break;
+                }
+                memset(grown + format_count, 0, (count - format_count) * sizeof(EassFormat*));
+                formats = grown;
+                format_count = count;
+            }
+            eass_format_free(formats[id]);
+            formats[id] = eass_format_compile(text);
+            free(text);
+            continue;
+        }
+        if (kind != 'L') {
+            _set_error(EINVAL, "unknown record in eass_binlog_decode");
+            result = -1;
+            break;
+        }
+
+        int positional = magic[0];
+        uint64_t timestamp;
+        uint32_t count;
+        if (_eass_binlog_read(in, &id, 4) != 0 || _eass_binlog_read(in, &timestamp, 8) != 0 ||
+            _eass_binlog_read(in, &count, 4) != 0) {
+            result = -1;
+            break;
+        }
+        if (id >= format_count || formats[id] == NULL) {
+            _set_error(EINVAL, "record uses an undefined template in eass_binlog_decode");
+            result = -1;
+            break;
+        }
+        if (count > arg_capacity) {
+            EassArg* grown_args = (EassArg*)realloc(args, count * sizeof(EassArg));
+            if (grown_args) args = grown_args;
+            DynamicValue* grown_values = (DynamicValue*)realloc(values, count * sizeof(DynamicValue));
+            if (grown_values) values = grown_values;
+            if (!grown_args || !grown_values) {
+                _set_error(ENOMEM, "realloc failed in eass_binlog_decode");
+                result = -1;
+                break;
+            }
+            arg_capacity = count;
+        }
+        uint32_t decoded = 0;
+        for (; decoded < count; decoded++) {
+            values[decoded].type = EASS_NULL;
+            if (_eass_binlog_read_arg(in, &args[decoded], &values[decoded]) != 0) {
+                free_dynamic_value(&values[decoded]);
+                result = -1;
+                break;
+            }
+        }
+        if (result == 0) {
+            _eass_sink_printf(&sink, "[%llu.%09llu] ", (unsigned long long)(timestamp / 1000000000u),
+                              (unsigned long long)(timestamp % 1000000000u));
+            if (_eass_vformat_args(&sink, formats[id], args, count, positional) != 0) {
+                const EassError* error = eass_get_last_error();
+                _eass_sink_printf(&sink, "Error: %d - %s", error->code, error->message);
+            }
+            _eass_sink_write(&sink, "\n", 1);
+        }
+        for (uint32_t i = 0; i < decoded; i++) {
+            free_dynamic_value(&values[i]);
+        }
+        if (result != 0) {
+            break;
+        }
+    }
+
+    eass_sink_flush(&sink);
+    if (sink.error && result == 0) {
+        _set_error(EIO, "write failed in eass_binlog_decode");
+        result = -1;
+    }
+    for (size_t i = 0; i < format_count; i++) {
+        eass_format_free(formats[i]);
+    }
+    free(formats);
+    free(args);
+    free(values);
+    return result;
+}
+
+// Function to read input from the console and automatically convert it to the appropriate data type.
+DynamicValue input(const char* prompt) {
+    // Queued and buffered print() output must appear before the prompt
+#ifdef EASS_HAS_ASYNC
+    _eass_async_drain();
+#endif
+    eass_flush();
+    printf("%s", prompt);
+    fflush(stdout);
+
+    // Read the line into a builder; typical answers fit in its inline storage
+    EassStr line = eass_str();
+    char chunk[EASS_INPUT_BUFFER_SIZE];
+    int got_input = 0;
+    while (fgets(chunk, sizeof(chunk), stdin)) {
+        size_t len = strlen(chunk);
+        got_input = 1;
+        if (len > 0 && chunk[len - 1] == '\n') {
+            eass_str_append(&line, chunk, len - 1);
+            break;
+        }
+        eass_str_append(&line, chunk, len);
+    }
+    if (!got_input || line.error) {
+        _set_error(line.error ? ENOMEM : errno, "reading input failed");
+        eass_str_free(&line);
+        DynamicValue empty = strlit_n("", 0);
+        empty.error = 1;
+        return empty;
+    }
+
+    const char* text = eass_str_cstr(&line);
+    if (text[0] != '\0') {
+        // Attempt to convert to integer
+        char* endptr;
+        long int_val = strtol(text, &endptr, 10);
+        if (*endptr == '\0') {
+            eass_str_free(&line);
+            return (DynamicValue){EASS_INT, 0, .value.i = (int)int_val};
+        }
+
+        // Attempt to convert to float
+        float float_val = strtof(text, &endptr);
+        if (*endptr == '\0') {
+            eass_str_free(&line);
+            return (DynamicValue){EASS_FLOAT, 0, .value.f = float_val};
+        }
+    }
+
+    // If it's not a number, return it as a string; short ones need no allocation
+    if (line.size < EASS_SSO_SIZE) {
+        DynamicValue val = strlit_n(text, line.size);
+        eass_str_free(&line);
+        return val;
+    }
+    return (DynamicValue){EASS_STRING, 0, .value.s = eass_str_release(&line)};
+}
+
+// Function to print an integer in hexadecimal and binary formats
+void printhd(int number) {
+#ifdef EASS_HAS_ASYNC
+    EassSink* scratch = _eass_async_begin(); // Keep the line in order with queued print() output
+    EassSink* sink = scratch ? scratch : _eass_stdout_sink();
+#else
+    EassSink* sink = _eass_stdout_sink();
+#endif
+    _eass_sink_printf(sink, "Hex: 0x%x | Binary: 0b", number);
+    for (int i = 31; i >= 0; i--) {
+        char bit = (char)('0' + ((number >> i) & 1));
+        _eass_sink_write(sink, &bit, 1);
+        if (i % 4 == 0 && i != 0) {
+            _eass_sink_write(sink, " ", 1); // Add space after every 4 bits
+        }
+    }
+    _eass_sink_write(sink, "\n", 1);
+#ifdef EASS_HAS_ASYNC
+    if (scratch) {
+        _eass_async_end(scratch);
+        return;
+    }
+#endif
+    if (_eass_flush_policy == EASS_FLUSH_LINE) {
+        eass_flush();
     }
-    printf("\n");
 }
 
 // Function to create DynamicValue with automatic type detection
-DynamicValue numlit(double value) {
+DynamicValue (numlit)(double value) { // Parenthesized so the numlit() macro is not expanded
     // This macro uses the _Generic keyword to determine the type of the argument at compile time.
     return _Generic(value,
                            int: (DynamicValue){EASS_INT, 0, .value.i = (int)value},
@@ -581,447 +4229,2345 @@ DynamicValue numlit(double value) {
     );
 }
 
-// Function to create a new dynamic array
-DynamicArray array(size_t initial_capacity) {
-    DynamicArray arr;
-    if (initial_capacity == 0) {
-        arr.data = NULL;
+// Function to create a string value holding a copy of text; short text is stored in place
+DynamicValue strlit(const char* text) {
+    if (text == NULL) {
+        _set_error(EINVAL, "strlit called with NULL text");
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0};
+    }
+    return strlit_n(text, strlen(text));
+}
+
+// Function to create a string value from the first len bytes of text
+DynamicValue strlit_n(const char* text, size_t len) {
+    DynamicValue val = {EASS_STRING, 0, .value.i = 0};
+    if (len < EASS_SSO_SIZE) {
+        val.flags = EASS_FLAG_INLINE;
+        memcpy(val.value.sso, text, len);
+        val.value.sso[len] = '\0';
+        return val;
+    }
+    val.value.s = (char*)malloc(len + 1);
+    if (!val.value.s) {
+        _set_error(ENOMEM, "malloc failed in strlit");
+        val.type = EASS_NULL;
+        val.error = 1;
+        return val;
+    }
+    memcpy(val.value.s, text, len);
+    val.value.s[len] = '\0';
+    return val;
+}
+
+// Function to get the text of a string value wherever it is stored; NULL for other types
+const char* string_value(const DynamicValue* val) {
+    if (val == NULL || val->type != EASS_STRING) {
+        return NULL;
+    }
+    return (val->flags & EASS_FLAG_INLINE) ? val->value.sso : val->value.s;
+}
+
+// Function to create a view of length bytes at data without copying or taking ownership
+DynamicValue strview(const char* data, size_t length) {
+    if (data == NULL && length > 0) {
+        _set_error(EINVAL, "strview called with NULL data");
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0};
+    }
+#ifdef EASS_COMPACT_VALUES
+    if (length > UINT32_MAX) {
+        _set_error(EOVERFLOW, "strview length does not fit a compact value");
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0};
+    }
+    DynamicValue val = {EASS_STRVIEW, 0, 0, (uint32_t)length, .value.sv = data};
+    return val;
+#else
+    return (DynamicValue){EASS_STRVIEW, 0, .value.sv = {data, length}};
+#endif
+}
+
+// Block of the arena that holds interned text
+typedef struct EassInternBlock {
+    struct EassInternBlock* next;
+    size_t used;
+    size_t capacity;
+    char data[];
+} EassInternBlock;
+
+// Slot of the intern hash table; text is NULL in an empty slot
+typedef struct {
+    const char* text;
+    size_t length;
+    uint64_t hash;
+} EassInternEntry;
+
+// Process-wide intern pool: an open-addressing table over text stored in arena blocks
+static struct {
+    EassInternEntry* entries;
+    size_t capacity; // Always a power of two
+    size_t count;
+    EassInternBlock* blocks;
+} _eass_intern_pool;
+
+#ifdef EASS_HAS_THREADS
+static atomic_flag _eass_intern_busy = ATOMIC_FLAG_INIT;
+#endif
+
+// Internal function to take the intern pool for the calling thread
+static void _eass_intern_lock(void) {
+#ifdef EASS_HAS_THREADS
+    while (atomic_flag_test_and_set_explicit(&_eass_intern_busy, memory_order_acquire)) {
+        thrd_yield();
+    }
+#endif
+}
+
+// Internal function to give the intern pool back
+static void _eass_intern_unlock(void) {
+#ifdef EASS_HAS_THREADS
+    atomic_flag_clear_explicit(&_eass_intern_busy, memory_order_release);
+#endif
+}
+
+// Internal function to hash text with 64-bit FNV-1a
+static uint64_t _eass_intern_hash(const char* text, size_t len) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ (unsigned char)text[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// Internal function to double the intern table; returns -1 when out of memory
+static int _eass_intern_grow(void) {
+    size_t capacity = _eass_intern_pool.capacity ? _eass_intern_pool.capacity * 2 : 256;
+    EassInternEntry* entries = (EassInternEntry*)calloc(capacity, sizeof(EassInternEntry));
+    if (!entries) {
+        return -1;
+    }
+    for (size_t i = 0; i < _eass_intern_pool.capacity; i++) {
+        const EassInternEntry* entry = &_eass_intern_pool.entries[i];
+        if (entry->text) {
+            size_t slot = (size_t)entry->hash & (capacity - 1);
+            while (entries[slot].text) {
+                slot = (slot + 1) & (capacity - 1);
+            }
+            entries[slot] = *entry;
+        }
+    }
+    free(_eass_intern_pool.entries);
+    _eass_intern_pool.entries = entries;
+    _eass_intern_pool.capacity = capacity;
+    return 0;
+}
+
+// Internal function to copy text into the arena; long text gets a block of its own
+static char* _eass_intern_store(const char* text, size_t len) {
+    EassInternBlock* block = _eass_intern_pool.blocks;
+    if (!block || block->capacity - block->used < len + 1) {
+        size_t capacity = len + 1 > EASS_INTERN_BLOCK_SIZE ? len + 1 : EASS_INTERN_BLOCK_SIZE;
+        block = (EassInternBlock*)malloc(sizeof(EassInternBlock) + capacity);
+        if (!block) {
+            return NULL;
+        }
+        block->used = 0;
+        block->capacity = capacity;
+        // Keep the partly used block in front unless the new one is a single long string
+        if (capacity > EASS_INTERN_BLOCK_SIZE && _eass_intern_pool.blocks) {
+            block->next = _eass_intern_pool.blocks->next;
+            _eass_intern_pool.blocks->next = block;
+        } else {
+            block->next = _eass_intern_pool.blocks;
+            _eass_intern_pool.blocks = block;
+        }
+    }
+    char* dest = block->data + block->used;
+    memcpy(dest, text, len);
+    dest[len] = '\0';
+    block->used += len + 1;
+    return dest;
+}
+
+// Function to get the pooled copy of the first len bytes of text; equal text always yields the
+// same pointer until eass_intern_clear()
+const char* eass_intern_n(const char* text, size_t len) {
+    if (text == NULL) {
+        _set_error(EINVAL, "eass_intern_n called with NULL text");
+        return NULL;
+    }
+    uint64_t hash = _eass_intern_hash(text, len);
+    const char* result = NULL;
+    _eass_intern_lock();
+    if ((_eass_intern_pool.count + 1) * 4 > _eass_intern_pool.capacity * 3 && _eass_intern_grow() != 0) {
+        _eass_intern_unlock();
+        _set_error(ENOMEM, "calloc failed in eass_intern_n");
+        return NULL;
+    }
+    size_t mask = _eass_intern_pool.capacity - 1;
+    size_t slot = (size_t)hash & mask;
+    for (;;) {
+        EassInternEntry* entry = &_eass_intern_pool.entries[slot];
+        if (entry->text == NULL) {
+            char* copy = _eass_intern_store(text, len);
+            if (copy) {
+                *entry = (EassInternEntry){copy, len, hash};
+                _eass_intern_pool.count++;
+            }
+            result = copy;
+            break;
+        }
+        if (entry->hash == hash && entry->length == len && memcmp(entry->text, text, len) == 0) {
+            result = entry->text;
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    _eass_intern_unlock();
+    if (!result) {
+        _set_error(ENOMEM, "malloc failed in eass_intern_n");
+    }
+    return result;
+}
+
+// Function to get the pooled copy of a C string
+const char* eass_intern(const char* text) {
+    if (text == NULL) {
+        _set_error(EINVAL, "eass_intern called with NULL text");
+        return NULL;
+    }
+    return eass_intern_n(text, strlen(text));
+}
+
+// Function to create a string value backed by the intern pool
+DynamicValue strintern(const char* text) {
+    const char* pooled = eass_intern(text);
+    if (!pooled) {
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0};
+    }
+    return (DynamicValue){EASS_STRING, 0, EASS_FLAG_INTERNED, .value.s = (char*)pooled};
+}
+
+// Function to move a string or string view into the intern pool; the original string is freed and
+// other values are returned unchanged
+DynamicValue intern_value(DynamicValue val) {
+    const char* pooled;
+    if (val.error || (val.flags & EASS_FLAG_INTERNED)) {
+        return val;
+    }
+    if (val.type == EASS_STRVIEW) {
+        pooled = eass_intern_n(EASS_VIEW_DATA(val), EASS_VIEW_LENGTH(val));
+    } else if (val.type == EASS_STRING && string_value(&val)) {
+        pooled = eass_intern(string_value(&val));
+        free_dynamic_value(&val);
+    } else {
+        return val;
+    }
+    if (!pooled) {
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0};
+    }
+    return (DynamicValue){EASS_STRING, 0, EASS_FLAG_INTERNED, .value.s = (char*)pooled};
+}
+
+// Function to get the number of distinct strings in the intern pool
+size_t eass_intern_count(void) {
+    _eass_intern_lock();
+    size_t count = _eass_intern_pool.count;
+    _eass_intern_unlock();
+    return count;
+}
+
+// Function to release the intern pool; every pointer and value it handed out becomes invalid
+void eass_intern_clear(void) {
+    _eass_intern_lock();
+    EassInternBlock* block = _eass_intern_pool.blocks;
+    while (block) {
+        EassInternBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+    free(_eass_intern_pool.entries);
+    _eass_intern_pool.entries = NULL;
+    _eass_intern_pool.capacity = 0;
+    _eass_intern_pool.count = 0;
+    _eass_intern_pool.blocks = NULL;
+    _eass_intern_unlock();
+}
+
+// Function to create a new dynamic array
+DynamicArray array(size_t initial_capacity) {
+    return array_packed(EASS_STORAGE_VALUES, initial_capacity);
+}
+
+// Internal function to get the size of one element of array storage
+static size_t _eass_storage_size(unsigned char storage) {
+    switch (storage) {
+        case EASS_STORAGE_INT:
+            return sizeof(int);
+        case EASS_STORAGE_FLOAT:
+            return sizeof(float);
+        case EASS_STORAGE_STRING:
+        case EASS_STORAGE_INTERNED:
+            return sizeof(char*);
+        default:
+            return sizeof(DynamicValue);
+    }
+}
+
+// Internal function to check whether a value fits the storage of an array as it is
+static int _eass_storage_accepts(unsigned char storage, const DynamicValue* val) {
+    if (val->error) {
+        return storage == EASS_STORAGE_VALUES;
+    }
+    switch (storage) {
+        case EASS_STORAGE_INT:
+            return val->type == EASS_INT;
+        case EASS_STORAGE_FLOAT:
+            return val->type == EASS_FLOAT;
+        case EASS_STORAGE_STRING:
+            return string_value(val) != NULL;
+        case EASS_STORAGE_INTERNED:
+            return string_value(val) != NULL || val->type == EASS_STRVIEW;
+        default:
+            return 1;
+    }
+}
+
+// Internal function to store a value accepted by _eass_storage_accepts() at index: heap strings
+// move into a packed string array, inline and pooled ones are copied, and an interned array keeps
+// the pooled copy. Call _eass_array_adopt() once the value is kept; returns -1 when out of memory
+static int _eass_array_store(DynamicArray* arr, size_t index, DynamicValue val) {
+    switch (arr->storage) {
+        case EASS_STORAGE_INT:
+            arr->ints[index] = val.value.i;
+            return 0;
+        case EASS_STORAGE_FLOAT:
+            arr->floats[index] = val.value.f;
+            return 0;
+        case EASS_STORAGE_STRING:
+            if (val.flags & (EASS_FLAG_INLINE | EASS_FLAG_INTERNED)) {
+                const char* text = string_value(&val);
+                size_t len = strlen(text);
+                char* copy = (char*)malloc(len + 1);
+                if (!copy) {
+                    _set_error(ENOMEM, "malloc failed storing a packed string");
+                    return -1;
+                }
+                memcpy(copy, text, len + 1);
+                arr->strings[index] = copy;
+            } else {
+                arr->strings[index] = val.value.s;
+            }
+            return 0;
+        case EASS_STORAGE_INTERNED: {
+            const char* pooled;
+            if (val.flags & EASS_FLAG_INTERNED) {
+                pooled = val.value.s;
+            } else if (val.type == EASS_STRVIEW) {
+                pooled = eass_intern_n(EASS_VIEW_DATA(val), EASS_VIEW_LENGTH(val));
+            } else {
+                pooled = eass_intern(string_value(&val));
+            }
+            if (!pooled) {
+                return -1;
+            }
+            arr->strings[index] = (char*)pooled;
+            return 0;
+        }
+        default:
+            arr->data[index] = val;
+            return 0;
+    }
+}
+
+// Internal function to free the part of a value stored by _eass_array_store() that the array did
+// not keep: an interned array only keeps the pooled copy
+static void _eass_array_adopt(const DynamicArray* arr, DynamicValue* val) {
+    if (arr->storage == EASS_STORAGE_INTERNED) {
+        free_dynamic_value(val);
+    }
+}
+
+// Internal function to undo _eass_array_store() at index before _eass_array_adopt(), leaving val
+// with the caller
+static void _eass_array_unstore(DynamicArray* arr, size_t index, const DynamicValue* val) {
+    if (arr->storage == EASS_STORAGE_STRING && (val->flags & (EASS_FLAG_INLINE | EASS_FLAG_INTERNED))) {
+        free(arr->strings[index]);
+    }
+}
+
+// Internal function to reallocate an array for exactly capacity elements; returns -1 on error and
+// leaves the array as it was
+static int _eass_array_set_capacity(DynamicArray* arr, size_t capacity) {
+    size_t elem_size = _eass_storage_size(arr->storage);
+    if (capacity == 0) {
+        free(arr->data);
+        arr->data = NULL;
+        arr->capacity = 0;
+        return 0;
+    }
+    if (capacity > SIZE_MAX / elem_size) {
+        _set_error(EOVERFLOW, "array capacity too large");
+        return -1;
+    }
+    void* data = _eass_realloc(arr->data, arr->capacity * elem_size, capacity * elem_size);
+    if (!data) {
+        _set_error(ENOMEM, "realloc failed resizing an array");
+        return -1;
+    }
+    arr->data = (DynamicValue*)data;
+    arr->capacity = capacity;
+    return 0;
+}
+
+// Internal function to make room for at least needed elements, growing by at least 1.5x so that
+// repeated appends stay amortized O(1); returns -1 on error
+static int _eass_array_grow(DynamicArray* arr, size_t needed) {
+    if (needed <= arr->capacity) {
+        return 0;
+    }
+    size_t new_cap = arr->capacity + (arr->capacity >> 1);
+    if (new_cap < needed) new_cap = needed;
+    if (new_cap < 4) new_cap = 4;
+    return _eass_array_set_capacity(arr, new_cap);
+}
+
+// Internal function to free the elements in [from, to) of an array without moving the others
+static void _eass_array_drop(DynamicArray* arr, size_t from, size_t to) {
+    // Ints, floats and pooled strings own nothing
+    for (size_t i = from; i < to; i++) {
+        if (arr->storage == EASS_STORAGE_STRING) {
+            free(arr->strings[i]);
+        } else if (arr->storage == EASS_STORAGE_VALUES) {
+            free_dynamic_value(&arr->data[i]);
+        }
+    }
+}
+
+// Function to create a dynamic array that stores ints, floats or strings packed, without the
+// DynamicValue around each one, until a value of another type is added
+DynamicArray array_packed(EassStorage storage, size_t initial_capacity) {
+    DynamicArray arr;
+    arr.storage = (unsigned char)storage;
+    if (initial_capacity == 0) {
+        arr.data = NULL;
+    }
+    else {
+        arr.data = (DynamicValue*)malloc(initial_capacity * _eass_storage_size(arr.storage));
+        if (arr.data == NULL)
+        {
+             _set_error(ENOMEM, "malloc failed in array");
+             arr.size = 0;
+             arr.capacity = 0;
+             arr.error = 1;
+             return arr;
+        }
+    }
+
+    arr.size = 0;
+    arr.capacity = initial_capacity;
+    arr.error = 0;
+    return arr;
+}
+
+// Function to wrap an array in a DynamicValue that owns it
+DynamicValue array_value(DynamicArray arr) {
+#ifdef EASS_COMPACT_VALUES
+    DynamicArray* holder = (DynamicArray*)malloc(sizeof(DynamicArray));
+    if (!holder) {
+        _set_error(ENOMEM, "malloc failed in array_value");
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0};
+    }
+    *holder = arr;
+    return (DynamicValue){EASS_ARRAY, 0, .value.a = holder};
+#else
+    return (DynamicValue){EASS_ARRAY, 0, .value.a = arr};
+#endif
+}
+
+// Function to switch a packed array to DynamicValue elements so that it can hold any type and be
+// read through data; returns 0 on success and -1 on error
+int array_unpack(DynamicArray* arr) {
+    if (arr == NULL) {
+        _set_error(EINVAL, "array_unpack called with NULL array");
+        return -1;
+    }
+    if (arr->error) {
+        return -1;
+    }
+    if (arr->storage == EASS_STORAGE_VALUES) {
+        return 0;
+    }
+    DynamicValue* data = NULL;
+    if (arr->capacity > 0) {
+        data = (DynamicValue*)malloc(arr->capacity * sizeof(DynamicValue));
+        if (!data) {
+            _set_error(ENOMEM, "malloc failed in array_unpack");
+            arr->error = 1;
+            return -1;
+        }
+    }
+    for (size_t i = 0; i < arr->size; i++) {
+        DynamicValue tmp;
+        data[i] = *_eass_element(arr->data, arr->storage, i, &tmp); // Strings change owner
+    }
+    free(arr->data);
+    arr->data = data;
+    arr->storage = EASS_STORAGE_VALUES;
+    return 0;
+}
+
+// Function to append an element to a dynamic array
+DynamicArray array_append(DynamicArray* arr, DynamicValue val) {
+    if (arr == NULL) {
+        _set_error(EINVAL, "array_append called with NULL array");
+        return (DynamicArray){{NULL}, 0, 0, 1, EASS_STORAGE_VALUES};
+    }
+    if (arr->error) {
+        return *arr; // Return the array with the existing error
+    }
+    if (!_eass_storage_accepts(arr->storage, &val) && array_unpack(arr) != 0) {
+        return *arr;
+    }
+    if (_eass_array_grow(arr, arr->size + 1) != 0) {
+        arr->error = 1;
+        return *arr;
+    }
+    if (_eass_array_store(arr, arr->size, val) != 0) {
+        arr->error = 1;
+        return *arr;
+    }
+    _eass_array_adopt(arr, &val);
+    arr->size++;
+    return *arr;
+}
+
+// Function to make room for at least capacity elements so that appending up to that many does not
+// reallocate; returns 0 on success and -1 on error
+int array_reserve(DynamicArray* arr, size_t capacity) {
+    if (arr == NULL) {
+        _set_error(EINVAL, "array_reserve called with NULL array");
+        return -1;
+    }
+    if (arr->error) {
+        return -1;
+    }
+    if (capacity <= arr->capacity) {
+        return 0;
+    }
+    return _eass_array_set_capacity(arr, capacity);
+}
+
+// Function to append count values to an array, taking ownership of them like array_append(), with
+// at most one reallocation; returns 0 on success and -1 on error, in which case the array and the
+// values are left as they were
+int array_extend(DynamicArray* arr, const DynamicValue* values, size_t count) {
+    if (arr == NULL || (values == NULL && count > 0)) {
+        _set_error(EINVAL, "array_extend called with NULL array or values");
+        return -1;
+    }
+    if (arr->error) {
+        return -1;
+    }
+    if (count > SIZE_MAX - arr->size) {
+        _set_error(EOVERFLOW, "too many elements in array_extend");
+        return -1;
+    }
+    if (arr->storage != EASS_STORAGE_VALUES) {
+        // A packed array keeps its layout only if every new value fits it
+        size_t fits = 0;
+        while (fits < count && _eass_storage_accepts(arr->storage, &values[fits])) {
+            fits++;
+        }
+        if (fits < count && array_unpack(arr) != 0) {
+            return -1;
+        }
+    }
+    if (_eass_array_grow(arr, arr->size + count) != 0) {
+        return -1;
+    }
+    if (arr->storage == EASS_STORAGE_VALUES) {
+        if (count > 0) {
+            memcpy(arr->data + arr->size, values, count * sizeof(DynamicValue));
+        }
+        arr->size += count;
+        return 0;
+    }
+    for (size_t i = 0; i < count; i++) {
+        if (_eass_array_store(arr, arr->size + i, values[i]) != 0) {
+            // Undo the partial extend so the array and the caller's values stay as they were
+            for (size_t k = 0; k < i; k++) {
+                _eass_array_unstore(arr, arr->size + k, &values[k]);
+            }
+            return -1;
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        DynamicValue kept = values[i];
+        _eass_array_adopt(arr, &kept);
+    }
+    arr->size += count;
+    return 0;
+}
+
+// Function to move every element of src to the end of arr; src is left empty and keeps its buffer.
+// Arrays with the same storage are joined with one memcpy. Returns 0 on success and -1 on error
+int array_extend_array(DynamicArray* arr, DynamicArray* src) {
+    if (arr == NULL || src == NULL || arr == src) {
+        _set_error(EINVAL, "array_extend_array needs two different arrays");
+        return -1;
+    }
+    if (arr->error || src->error) {
+        return -1;
+    }
+    if (src->size > SIZE_MAX - arr->size) {
+        _set_error(EOVERFLOW, "too many elements in array_extend_array");
+        return -1;
+    }
+    if (arr->storage != src->storage && arr->storage != EASS_STORAGE_VALUES) {
+        size_t fits = 0;
+        DynamicValue tmp;
+        while (fits < src->size && _eass_storage_accepts(arr->storage, _eass_element(src->data, src->storage, fits, &tmp))) {
+            fits++;
+        }
+        if (fits < src->size && array_unpack(arr) != 0) {
+            return -1;
+        }
+    }
+    if (_eass_array_grow(arr, arr->size + src->size) != 0) {
+        return -1;
+    }
+    size_t elem_size = _eass_storage_size(src->storage);
+    if (arr->storage == src->storage) {
+        if (src->size > 0) {
+            memcpy((char*)arr->data + arr->size * elem_size, src->data, src->size * elem_size);
+        }
+        arr->size += src->size;
+        src->size = 0;
+        return 0;
+    }
+    for (size_t i = 0; i < src->size; i++) {
+        DynamicValue tmp;
+        DynamicValue moved = *_eass_element(src->data, src->storage, i, &tmp);
+        if (_eass_array_store(arr, arr->size, moved) != 0) {
+            // Keep the elements that did not move in src
+            memmove(src->data, (char*)src->data + i * elem_size, (src->size - i) * elem_size);
+            src->size -= i;
+            return -1;
+        }
+        _eass_array_adopt(arr, &moved);
+        arr->size++;
+    }
+    src->size = 0;
+    return 0;
+}
+
+// Function to set the number of elements: removed elements are freed and new ones are NULL values,
+// or 0 and NULL in packed arrays. Returns 0 on success and -1 on error
+int array_resize(DynamicArray* arr, size_t size) {
+    if (arr == NULL) {
+        _set_error(EINVAL, "array_resize called with NULL array");
+        return -1;
+    }
+    if (arr->error) {
+        return -1;
+    }
+    if (size < arr->size) {
+        _eass_array_drop(arr, size, arr->size);
+    } else if (size > arr->size) {
+        if (_eass_array_grow(arr, size) != 0) {
+            return -1;
+        }
+        if (arr->storage == EASS_STORAGE_VALUES) {
+            for (size_t i = arr->size; i < size; i++) {
+                arr->data[i] = (DynamicValue){EASS_NULL, 0, .value.i = 0};
+            }
+        } else {
+            size_t elem_size = _eass_storage_size(arr->storage);
+            memset((char*)arr->data + arr->size * elem_size, 0, (size - arr->size) * elem_size);
+        }
+    }
+    arr->size = size;
+    return 0;
+}
+
+// Function to release the capacity an array does not use; returns 0 on success and -1 on error
+int array_shrink_to_fit(DynamicArray* arr) {
+    if (arr == NULL) {
+        _set_error(EINVAL, "array_shrink_to_fit called with NULL array");
+        return -1;
+    }
+    if (arr->error) {
+        return -1;
+    }
+    if (arr->capacity == arr->size) {
+        return 0;
+    }
+    return _eass_array_set_capacity(arr, arr->size);
+}
+
+// Function to free the memory allocated for a dynamic array
+void free_dynamic_array(DynamicArray* arr) {
+    if (arr) {
+        _eass_array_drop(arr, 0, arr->size);
+        free(arr->data);
+        arr->data = NULL;
+    }
+}
+
+// Function tofree the memory allocated for a DynamicValue
+void free_dynamic_value(DynamicValue* val) {
+    if (val) {
+        switch (val->type) {
+            case EASS_STRING:
+                if (!(val->flags & (EASS_FLAG_INLINE | EASS_FLAG_INTERNED)) && val->value.s) free(val->value.s);
+                break;
+            case EASS_ARRAY:
+#ifdef EASS_COMPACT_VALUES
+                if (val->value.a) {
+                    free_dynamic_array(val->value.a);
+                    free(val->value.a);
+                }
+#else
+                free_dynamic_array(&val->value.a);
+#endif
+                break;
+            // No need to free int, float or a borrowed EASS_STRVIEW
+            default:
+                break;
+        }
+        val->type = EASS_NULL; // Set type to NULL after freeing to prevent double freeing
+        val->flags = 0;
+    }
+}
+
+// Internal function to get the exact length of a formatted string; returns -1 on an error value
+static int _eass_string_measure(const EassFormat* fmt, const DynamicValue* values, size_t* length) {
+    size_t current_arg = 0;
+    *length = 0;
+    for (size_t op = 0; op < fmt->op_count; op++) {
+        const EassFormatOp* current = &fmt->ops[op];
+        if (current->kind == EASS_OP_LITERAL) {
+            *length += current->length;
+            continue;
+        }
+        size_t index = (current->kind == EASS_OP_NEXT_ARG) ? current_arg++ : (size_t)current->index;
+        if (current->has_spec) {
+            // Padded and converted values are measured by rendering them without storing
+            EassSink counter = eass_sink_buffer(NULL, 0);
+            if (_eass_sink_spec_value(&counter, &current->spec, &values[index]) != 0) {
+                return -1;
+            }
+            *length += counter.total;
+        } else if (_eass_value_length(&values[index], length) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Internal function to write a formatted string measured by _eass_string_measure() and terminate it
+static void _eass_string_render(EassSink* sink, const EassFormat* fmt, const DynamicValue* values) {
+    size_t current_arg = 0;
+    for (size_t op = 0; op < fmt->op_count; op++) {
+        const EassFormatOp* current = &fmt->ops[op];
+        if (current->kind == EASS_OP_LITERAL) {
+            _eass_sink_write(sink, fmt->text + current->offset, current->length);
+            continue;
+        }
+        size_t index = (current->kind == EASS_OP_NEXT_ARG) ? current_arg++ : (size_t)current->index;
+        _eass_sink_op_value(sink, current, &values[index]);
+    }
+    _eass_sink_terminate(sink);
+}
+
+// Function to create an empty string builder
+EassStr eass_str(void) {
+    EassStr str = {NULL, 0, 0, 0, {0}};
+    return str;
+}
+
+// Function to get the text of a builder, always NUL-terminated
+const char* eass_str_cstr(const EassStr* str) {
+    return str->heap ? str->heap : str->small;
+}
+
+// Function to make room for extra more characters. Appending to existing text grows the
+// storage geometrically; the first heap allocation of an empty builder is exact.
+int eass_str_reserve(EassStr* str, size_t extra) {
+    size_t capacity = str->heap ? str->capacity : EASS_STR_INLINE_SIZE - 1;
+    size_t needed = str->size + extra;
+    if (needed <= capacity) {
+        return 0;
+    }
+    size_t new_cap = capacity * 2;
+    if (str->size == 0 || new_cap < needed) new_cap = needed;
+    char* heap;
+    if (str->heap) {
+        heap = (char*)_eass_realloc(str->heap, str->capacity + 1, new_cap + 1);
+    } else {
+        heap = (char*)malloc(new_cap + 1);
+        if (heap) memcpy(heap, str->small, str->size + 1);
+    }
+    if (!heap) {
+        _set_error(ENOMEM, "malloc failed in eass_str_reserve");
+        str->error = 1;
+        return -1;
+    }
+    str->heap = heap;
+    str->capacity = new_cap;
+    return 0;
+}
+
+// Function to append len bytes to a builder
+int eass_str_append(EassStr* str, const char* data, size_t len) {
+    if (eass_str_reserve(str, len) != 0) {
+        return -1;
+    }
+    char* text = str->heap ? str->heap : str->small;
+    memcpy(text + str->size, data, len);
+    str->size += len;
+    text[str->size] = '\0';
+    return 0;
+}
+
+// Function to append a C string to a builder
+int eass_str_append_cstr(EassStr* str, const char* text) {
+    return eass_str_append(str, text, strlen(text));
+}
+
+// Function to append an integer to a builder
+int eass_str_append_int(EassStr* str, long long value) {
+    char number[32];
+    return eass_str_append(str, number, _eass_format_int64(number, value));
+}
+
+// Function to append a float to a builder, printed like print() does
+int eass_str_append_float(EassStr* str, float value) {
+    char number[32];
+    return eass_str_append(str, number, _eass_format_float(number, value));
+}
+
+// Function to append a double to a builder, with the fewest digits that read back exactly
+int eass_str_append_double(EassStr* str, double value) {
+    char number[32];
+    return eass_str_append(str, number, _eass_format_double(number, value));
+}
+
+// Function to append a value to a builder as print() would show it; the value is borrowed.
+// Returns -1 for an error value.
+int eass_str_append_value(EassStr* str, const DynamicValue* val) {
+    EassSink sink = eass_sink_str(str);
+    if (_eass_sink_value(&sink, val) != 0 || sink.error) {
+        return -1;
+    }
+    return 0;
+}
+
+// Internal function to append a formatted string to a builder, measuring it first so the
+// builder grows at most once; frees the arguments like string_format()
+static int _eass_str_vappendf(EassStr* str, const EassFormat* fmt, va_list args) {
+    DynamicValue stack_values[EASS_FORMAT_STACK_ARGS];
+    size_t count;
+    DynamicValue* values = _eass_string_args(fmt, args, stack_values, &count);
+    if (!values) {
+        return -1;
+    }
+    int result = -1;
+    size_t length;
+    if (_eass_string_measure(fmt, values, &length) == 0 && eass_str_reserve(str, length) == 0) {
+        char* text = str->heap ? str->heap : str->small;
+        EassSink sink = eass_sink_buffer(text + str->size, length + 1);
+        _eass_string_render(&sink, fmt, values);
+        str->size += length;
+        result = 0;
+    }
+    _eass_string_args_free(values, count, stack_values);
+    return result;
+}
+
+// Function to append a formatted string to a builder; takes ownership of the arguments
+int eass_str_appendf(EassStr* str, const char* format, ...) {
+    const EassFormat* fmt = _eass_format_lookup(format);
+    if (!fmt) {
+        return -1;
+    }
+    va_list args;
+    va_start(args, format);
+    int result = _eass_str_vappendf(str, fmt, args);
+    va_end(args);
+    return result;
+}
+
+// Function to take the text of a builder as a heap string the caller frees; the builder is
+// left empty
+char* eass_str_release(EassStr* str) {
+    char* text = str->heap;
+    if (!text) {
+        text = (char*)malloc(str->size + 1);
+        if (!text) {
+            _set_error(ENOMEM, "malloc failed in eass_str_release");
+            return NULL;
+        }
+        memcpy(text, str->small, str->size + 1);
+    }
+    *str = eass_str();
+    return text;
+}
+
+// Function to empty a builder but keep its storage
+void eass_str_clear(EassStr* str) {
+    str->size = 0;
+    str->error = 0;
+    if (str->heap) {
+        str->heap[0] = '\0';
+    } else {
+        str->small[0] = '\0';
+    }
+}
+
+// Function to free the storage of a builder
+void eass_str_free(EassStr* str) {
+    if (str) {
+        free(str->heap);
+        *str = eass_str();
+    }
+}
+
+// Internal function behind string_format() and string_format_compiled()
+static char* _eass_string_vformat(const EassFormat* fmt, va_list args) {
+    // The result is measured first, so a long string takes one allocation of the exact size
+    EassStr str = eass_str();
+    if (_eass_str_vappendf(&str, fmt, args) != 0) {
+        eass_str_free(&str);
+        return NULL;
+    }
+    return eass_str_release(&str);
+}
+
+// Function to format strings, similar to Python's format()
+char* string_format(const char* format, ...) {
+    const EassFormat* fmt = _eass_format_lookup(format);
+    if (!fmt) {
+        return NULL;
+    }
+    va_list args;
+    va_start(args, format);
+    char* result = _eass_string_vformat(fmt, args);
+    va_end(args);
+    return result;
+}
+
+// Function to format strings with a template from eass_format_compile()
+char* string_format_compiled(const EassFormat* fmt, ...) {
+    if (fmt == NULL) {
+        _set_error(EINVAL, "string_format_compiled called with NULL template");
+        return NULL;
+    }
+    va_list args;
+    va_start(args, fmt);
+    char* result = _eass_string_vformat(fmt, args);
+    va_end(args);
+    return result;
+}
+
+// Function to format into a caller buffer like snprintf(): writes at most capacity - 1 characters
+// and a terminator, and returns the full length of the result, or -1 for an error value
+int string_format_into(char* buf, size_t capacity, const char* format, ...) {
+    const EassFormat* fmt = _eass_format_lookup(format);
+    if (!fmt) {
+        return -1;
+    }
+    DynamicValue stack_values[EASS_FORMAT_STACK_ARGS];
+    size_t count;
+    va_list args;
+    va_start(args, format);
+    DynamicValue* values = _eass_string_args(fmt, args, stack_values, &count);
+    va_end(args);
+    if (!values) {
+        return -1;
+    }
+
+    int result = -1;
+    size_t length;
+    if (_eass_string_measure(fmt, values, &length) == 0) {
+        if (length > INT_MAX) {
+            _set_error(EOVERFLOW, "result too long in string_format_into");
+        } else {
+            EassSink sink = eass_sink_buffer(buf, buf ? capacity : 0);
+            _eass_string_render(&sink, fmt, values);
+            result = (int)length;
+        }
+    } else if (buf && capacity > 0) {
+        buf[0] = '\0';
+    }
+    _eass_string_args_free(values, count, stack_values);
+    return result;
+}
+
+// Function to make an arena over caller memory for string_format_arena()
+EassArena eass_arena(void* buf, size_t capacity) {
+    EassArena arena = {(char*)buf, 0, buf ? capacity : 0};
+    return arena;
+}
+
+// Function to release every string allocated from an arena at once
+void eass_arena_reset(EassArena* arena) {
+    if (arena) {
+        arena->size = 0;
+    }
+}
+
+// Function to format a string allocated from an arena; returns NULL if it does not fit
+char* string_format_arena(EassArena* arena, const char* format, ...) {
+    if (arena == NULL) {
+        _set_error(EINVAL, "string_format_arena called with NULL arena");
+        return NULL;
+    }
+    const EassFormat* fmt = _eass_format_lookup(format);
+    if (!fmt) {
+        return NULL;
+    }
+    DynamicValue stack_values[EASS_FORMAT_STACK_ARGS];
+    size_t count;
+    va_list args;
+    va_start(args, format);
+    DynamicValue* values = _eass_string_args(fmt, args, stack_values, &count);
+    va_end(args);
+    if (!values) {
+        return NULL;
+    }
+
+    char* result = NULL;
+    size_t length;
+    if (_eass_string_measure(fmt, values, &length) == 0) {
+        if (length < arena->capacity - arena->size) {
+            result = arena->data + arena->size;
+            arena->size += length + 1;
+            EassSink sink = eass_sink_buffer(result, length + 1);
+            _eass_string_render(&sink, fmt, values);
+        } else {
+            _set_error(ENOMEM, "arena full in string_format_arena");
+        }
+    }
+    _eass_string_args_free(values, count, stack_values);
+    return result;
+}
+
+// Function to format packed arguments; normally called through the string_format_typed() macro
+char* string_format_args(const char* format, const EassArg* args, size_t count) {
+    const EassFormat* fmt = _eass_format_lookup(format);
+    if (!fmt) {
+        return NULL;
+    }
+    EassStr str = eass_str();
+    EassSink sink = eass_sink_str(&str);
+    if (_eass_vformat_args(&sink, fmt, args, count, 1) != 0 || sink.error) {
+        eass_str_free(&str);
+        return NULL;
+    }
+    return eass_str_release(&str);
+}
+
+// Function to read the entire content of a file into a string
+char* read_file(const char* filename) {
+    FILE* file = fopen(filename, "rb");
+    if (!file) {
+        _set_error(errno, "fopen failed in read_file");
+        return NULL;
+    }
+
+    fseek(file, 0, SEEK_END);
+    long file_size = ftell(file);
+    if (file_size == -1) {
+        _set_error(errno, "ftell failed in read_file");
+        fclose(file);
+        return NULL;
+    }
+    fseek(file, 0, SEEK_SET);
+
+    char* buffer = (char*)malloc(file_size + 1);
+    if (!buffer) {
+        _set_error(ENOMEM, "malloc failed in read_file");
+        fclose(file);
+        return NULL;
+    }
+
+    size_t bytes_read = fread(buffer, 1, file_size, file);
+    if (bytes_read != (size_t)file_size) {
+        _set_error(errno, "fread failed in read_file");
+        fclose(file);
+        free(buffer);
+        return NULL;
+    }
+    buffer[file_size] = '\0'; // Null terminate
+
+    fclose(file);
+    return buffer;
+}
+
+// Function to write a string to a file
+int write_file(const char* filename, const char* content) {
+    FILE* file = fopen(filename, "wb");
+    if (!file) {
+        _set_error(errno, "fopen failed in write_file");
+        return -1;
+    }
+
+    size_t content_length = strlen(content);
+    size_t bytes_written = fwrite(content, 1, content_length, file);
+    if (bytes_written != content_length) {
+        _set_error(errno, "fwrite failed in write_file");
+        fclose(file);
+        return -1;
+    }
+
+    fclose(file);
+    return 0;
+}
+
+// Function to get the current time in seconds
+double get_time_in_seconds() {
+#ifdef _WIN32
+    // Use GetTickCount64 on Windows
+    DWORD64 ticks = GetTickCount64();
+    return (double)ticks / 1000.0; // Convert milliseconds to seconds
+#else
+    // Use gettimeofday on Linux/macOS
+    struct timeval tv;
+    if (gettimeofday(&tv, NULL) != 0) {
+        _set_error(errno, "gettimeofday failed in get_time_in_seconds");
+        return 0.0; // Return 0.0 on error, or handle the error as appropriate for your application
+    }
+    return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0; // Convert to seconds
+#endif
+}
+
+// Function to insert a value into a dynamic array at a specified index
+DynamicArray array_insert(DynamicArray* arr, size_t index, DynamicValue val) {
+    if (arr == NULL) {
+        _set_error(EINVAL, "array_insert called with NULL array");
+        return (DynamicArray){{NULL}, 0, 0, 1, EASS_STORAGE_VALUES};
     }
-    else {
-        arr.data = (DynamicValue*)malloc(initial_capacity * sizeof(DynamicValue));
-        if (arr.data == NULL)
-        {
-             _set_error(ENOMEM, "malloc failed in array");
-             arr.error = 1;
-             return arr;
+    if (arr->error) {
+        return *arr; // Return the array with the existing error
+    }
+    if (index > arr->size) {
+        _set_error(EINVAL, "Index out of bounds in array_insert");
+        return *arr;
+    }
+    if (array_insert_range(arr, index, &val, 1) != 0) {
+        arr->error = 1;
+    }
+    return *arr;
+}
+
+// Function to insert count values at index, taking ownership of them, by opening the gap with one
+// memmove; returns 0 on success and -1 on error
+int array_insert_range(DynamicArray* arr, size_t index, const DynamicValue* values, size_t count) {
+    if (arr == NULL || (values == NULL && count > 0)) {
+        _set_error(EINVAL, "array_insert_range called with NULL array or values");
+        return -1;
+    }
+    if (arr->error) {
+        return -1;
+    }
+    if (index > arr->size) {
+        _set_error(EINVAL, "Index out of bounds in array_insert_range");
+        return -1;
+    }
+    if (count > SIZE_MAX - arr->size) {
+        _set_error(EOVERFLOW, "too many elements in array_insert_range");
+        return -1;
+    }
+    if (arr->storage != EASS_STORAGE_VALUES) {
+        size_t fits = 0;
+        while (fits < count && _eass_storage_accepts(arr->storage, &values[fits])) {
+            fits++;
+        }
+        if (fits < count && array_unpack(arr) != 0) {
+            return -1;
+        }
+    }
+    if (count == 0) {
+        return 0;
+    }
+    if (_eass_array_grow(arr, arr->size + count) != 0) {
+        return -1;
+    }
+
+    size_t elem_size = _eass_storage_size(arr->storage);
+    char* base = (char*)arr->data;
+    memmove(base + (index + count) * elem_size, base + index * elem_size, (arr->size - index) * elem_size);
+    if (arr->storage == EASS_STORAGE_VALUES) {
+        memcpy(arr->data + index, values, count * sizeof(DynamicValue));
+    } else {
+        for (size_t i = 0; i < count; i++) {
+            if (_eass_array_store(arr, index + i, values[i]) != 0) {
+                // Undo the partial insert so the array and the caller's values stay as they were
+                for (size_t k = 0; k < i; k++) {
+                    _eass_array_unstore(arr, index + k, &values[k]);
+                }
+                memmove(base + index * elem_size, base + (index + count) * elem_size, (arr->size - index) * elem_size);
+                return -1;
+            }
+        }
+        for (size_t i = 0; i < count; i++) {
+            DynamicValue kept = values[i];
+            _eass_array_adopt(arr, &kept);
+        }
+    }
+    arr->size += count;
+    return 0;
+}
+
+// Function to free count elements starting at index and close the gap with one memmove; returns 0
+// on success and -1 on error
+int array_remove_range(DynamicArray* arr, size_t index, size_t count) {
+    if (arr == NULL) {
+        _set_error(EINVAL, "array_remove_range called with NULL array");
+        return -1;
+    }
+    if (arr->error) {
+        return -1;
+    }
+    if (index > arr->size || count > arr->size - index) {
+        _set_error(EINVAL, "Index out of bounds in array_remove_range");
+        return -1;
+    }
+    _eass_array_drop(arr, index, index + count);
+    size_t elem_size = _eass_storage_size(arr->storage);
+    char* base = (char*)arr->data;
+    if (count > 0) {
+        memmove(base + index * elem_size, base + (index + count) * elem_size, (arr->size - index - count) * elem_size);
+    }
+    arr->size -= count;
+    return 0;
+}
+
+// Function to remove an element from a dynamic array at a specified index
+DynamicValue array_remove(DynamicArray* arr, size_t index) {
+    if (arr == NULL) {
+        _set_error(EINVAL, "array_remove called with NULL array");
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0}; // Return a default invalid DynamicValue
+    }
+    if (arr->error) {
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0}; // Return a default invalid DynamicValue
+    }
+    if (index >= arr->size) {
+        _set_error(EINVAL, "Index out of bounds in array_remove");
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0}; // Return a default invalid DynamicValue
+    }
+
+    DynamicValue tmp;
+    DynamicValue removed_val = *_eass_element(arr->data, arr->storage, index, &tmp); // Copy the value to be removed
+
+    // Shift elements to fill the gap
+    size_t elem_size = _eass_storage_size(arr->storage);
+    char* base = (char*)arr->data;
+    memmove(base + index * elem_size, base + (index + 1) * elem_size, (arr->size - index - 1) * elem_size);
+
+    arr->size--;
+    return removed_val; // Return the removed value
+}
+
+// Function to get an element from a dynamic array at a specified index
+DynamicValue array_get(const DynamicArray* arr, size_t index) {
+    if (arr == NULL) {
+        _set_error(EINVAL, "array_get called with NULL array");
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0};
+    }
+    if (arr->error) {
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0};
+    }
+    if (index >= arr->size) {
+        _set_error(EINVAL, "Index out of bounds in array_get");
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0};
+    }
+
+    DynamicValue tmp;
+    return *_eass_element(arr->data, arr->storage, index, &tmp);
+}
+
+// Function to join the elements of an array, written as print() shows them, into one new string
+char* array_join(const DynamicArray* arr, const char* sep) {
+    if (arr == NULL) {
+        _set_error(EINVAL, "array_join called with NULL array");
+        return NULL;
+    }
+    if (arr->error) {
+        return NULL;
+    }
+    if (sep == NULL) {
+        sep = "";
+    }
+    size_t sep_len = strlen(sep);
+
+    // Measure everything first so the result is a single exact allocation
+    size_t length = arr->size > 1 ? (arr->size - 1) * sep_len : 0;
+    int all_text = 1;
+    for (size_t i = 0; i < arr->size; i++) {
+        DynamicValue tmp;
+        const DynamicValue* val = _eass_element(arr->data, arr->storage, i, &tmp);
+        if (!val->error && val->type == EASS_STRVIEW) {
+            length += EASS_VIEW_LENGTH(*val);
+        } else if (!val->error && string_value(val)) {
+            length += strlen(string_value(val));
+        } else {
+            all_text = 0;
+            if (_eass_value_length(val, &length) != 0) {
+                _set_error(EINVAL, "array_join found an error value");
+                return NULL;
+            }
+        }
+    }
+
+    char* result = (char*)malloc(length + 1);
+    if (!result) {
+        _set_error(ENOMEM, "malloc failed in array_join");
+        return NULL;
+    }
+    if (all_text) {
+        // Only strings: copy them without going through the sink
+        char* dest = result;
+        for (size_t i = 0; i < arr->size; i++) {
+            DynamicValue tmp;
+            const DynamicValue* val = _eass_element(arr->data, arr->storage, i, &tmp);
+            if (i > 0) {
+                memcpy(dest, sep, sep_len);
+                dest += sep_len;
+            }
+            const char* text = val->type == EASS_STRVIEW ? EASS_VIEW_DATA(*val) : string_value(val);
+            size_t text_len = val->type == EASS_STRVIEW ? EASS_VIEW_LENGTH(*val) : strlen(text);
+            memcpy(dest, text, text_len);
+            dest += text_len;
+        }
+        *dest = '\0';
+    } else {
+        EassSink sink = eass_sink_buffer(result, length + 1);
+        for (size_t i = 0; i < arr->size; i++) {
+            DynamicValue tmp;
+            if (i > 0) {
+                _eass_sink_write(&sink, sep, sep_len);
+            }
+            _eass_sink_value(&sink, _eass_element(arr->data, arr->storage, i, &tmp));
+        }
+        _eass_sink_terminate(&sink);
+    }
+    return result;
+}
+
+// Reductions computed by _eass_array_reduce()
+typedef enum {
+    EASS_REDUCE_SUM,
+    EASS_REDUCE_MEAN,
+    EASS_REDUCE_MIN,
+    EASS_REDUCE_MAX,
+    EASS_REDUCE_ARGMIN,
+    EASS_REDUCE_ARGMAX
+} EassReduceOp;
+
+// Internal function to add up packed ints without overflow
+static int64_t _eass_sum_i32(const int* data, size_t n) {
+    size_t i = 0;
+    int64_t total = 0;
+#if defined(EASS_USE_AVX2)
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 8 <= n; i += 8) {
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(data + i))));
+        acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)(data + i + 4))));
+    }
+    int64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, acc);
+    total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(EASS_USE_SSE2)
+    // Widen to 64 bits by pairing each lane with its sign
+    __m128i acc = _mm_setzero_si128();
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i*)(data + i));
+        __m128i sign = _mm_cmpgt_epi32(zero, x);
+        acc = _mm_add_epi64(acc, _mm_unpacklo_epi32(x, sign));
+        acc = _mm_add_epi64(acc, _mm_unpackhi_epi32(x, sign));
+    }
+    int64_t lanes[2];
+    _mm_storeu_si128((__m128i*)lanes, acc);
+    total = lanes[0] + lanes[1];
+#endif
+    for (; i < n; i++) {
+        total += data[i];
+    }
+    return total;
+}
+
+// Internal function to add up packed floats in double precision
+static double _eass_sum_f32(const float* data, size_t n) {
+    size_t i = 0;
+    double total = 0.0;
+#if defined(EASS_USE_AVX2)
+    __m256d acc = _mm256_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        acc = _mm256_add_pd(acc, _mm256_cvtps_pd(_mm_loadu_ps(data + i)));
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, acc);
+    total = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(EASS_USE_SSE2)
+    __m128d acc = _mm_setzero_pd();
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(data + i);
+        acc = _mm_add_pd(acc, _mm_cvtps_pd(x));
+        acc = _mm_add_pd(acc, _mm_cvtps_pd(_mm_movehl_ps(x, x)));
+    }
+    double lanes[2];
+    _mm_storeu_pd(lanes, acc);
+    total = lanes[0] + lanes[1];
+#endif
+    for (; i < n; i++) {
+        total += data[i];
+    }
+    return total;
+}
+
+// Internal function to find the smallest or largest of n > 0 packed ints
+static int _eass_extreme_i32(const int* data, size_t n, int want_max) {
+    size_t i = 0;
+    int best = data[0];
+#if defined(EASS_USE_AVX2)
+    if (n >= 8) {
+        __m256i acc = _mm256_loadu_si256((const __m256i*)data);
+        for (i = 8; i + 8 <= n; i += 8) {
+            __m256i x = _mm256_loadu_si256((const __m256i*)(data + i));
+            acc = want_max ? _mm256_max_epi32(acc, x) : _mm256_min_epi32(acc, x);
+        }
+        int lanes[8];
+        _mm256_storeu_si256((__m256i*)lanes, acc);
+        for (int k = 0; k < 8; k++) {
+            if (want_max ? lanes[k] > best : lanes[k] < best) best = lanes[k];
+        }
+    }
+#elif defined(EASS_USE_SSE2)
+    if (n >= 4) {
+        // SSE2 has no 32-bit min/max, so select with a comparison mask
+        __m128i acc = _mm_loadu_si128((const __m128i*)data);
+        for (i = 4; i + 4 <= n; i += 4) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(data + i));
+            __m128i take = want_max ? _mm_cmpgt_epi32(x, acc) : _mm_cmplt_epi32(x, acc);
+            acc = _mm_or_si128(_mm_and_si128(take, x), _mm_andnot_si128(take, acc));
+        }
+        int lanes[4];
+        _mm_storeu_si128((__m128i*)lanes, acc);
+        for (int k = 0; k < 4; k++) {
+            if (want_max ? lanes[k] > best : lanes[k] < best) best = lanes[k];
+        }
+    }
+#endif
+    for (; i < n; i++) {
+        if (want_max ? data[i] > best : data[i] < best) best = data[i];
+    }
+    return best;
+}
+
+// Internal function to find the smallest or largest of packed floats, skipping NaN; gives an
+// infinity if every element is NaN
+static float _eass_extreme_f32(const float* data, size_t n, int want_max) {
+    size_t i = 0;
+    float best = want_max ? -INFINITY : INFINITY;
+#if defined(EASS_USE_AVX2)
+    // min/max return their second operand when either is NaN, which keeps NaN out of acc
+    __m256 acc = _mm256_set1_ps(best);
+    for (; i + 8 <= n; i += 8) {
+        __m256 x = _mm256_loadu_ps(data + i);
+        acc = want_max ? _mm256_max_ps(x, acc) : _mm256_min_ps(x, acc);
+    }
+    float lanes[8];
+    _mm256_storeu_ps(lanes, acc);
+    for (int k = 0; k < 8; k++) {
+        if (want_max ? lanes[k] > best : lanes[k] < best) best = lanes[k];
+    }
+#elif defined(EASS_USE_SSE2)
+    __m128 acc = _mm_set1_ps(best);
+    for (; i + 4 <= n; i += 4) {
+        __m128 x = _mm_loadu_ps(data + i);
+        acc = want_max ? _mm_max_ps(x, acc) : _mm_min_ps(x, acc);
+    }
+    float lanes[4];
+    _mm_storeu_ps(lanes, acc);
+    for (int k = 0; k < 4; k++) {
+        if (want_max ? lanes[k] > best : lanes[k] < best) best = lanes[k];
+    }
+#endif
+    for (; i < n; i++) {
+        if (want_max ? data[i] > best : data[i] < best) best = data[i];
+    }
+    return best;
+}
+
+// Internal function to turn an element count or index into an EASS_INT value
+static DynamicValue _eass_reduce_index(size_t index) {
+    if (index > INT_MAX) {
+        _set_error(EOVERFLOW, "array index does not fit an int");
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0};
+    }
+    return (DynamicValue){EASS_INT, 0, .value.i = (int)index};
+}
+
+// Internal function to turn a 64-bit sum into an EASS_INT value
+static DynamicValue _eass_reduce_int(int64_t total) {
+    if (total > INT_MAX || total < INT_MIN) {
+        _set_error(EOVERFLOW, "array_sum result does not fit an int");
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0};
+    }
+    return (DynamicValue){EASS_INT, 0, .value.i = (int)total};
+}
+
+// Internal function to reduce a packed int array
+static DynamicValue _eass_reduce_ints(const DynamicArray* arr, EassReduceOp op) {
+    const int* data = arr->ints;
+    size_t n = arr->size;
+    if (op == EASS_REDUCE_SUM) {
+        return _eass_reduce_int(_eass_sum_i32(data, n));
+    }
+    if (op == EASS_REDUCE_MEAN) {
+        return (DynamicValue){EASS_FLOAT, 0, .value.f = (float)((double)_eass_sum_i32(data, n) / (double)n)};
+    }
+    int want_max = (op == EASS_REDUCE_MAX || op == EASS_REDUCE_ARGMAX);
+    int best = _eass_extreme_i32(data, n, want_max);
+    if (op == EASS_REDUCE_MIN || op == EASS_REDUCE_MAX) {
+        return (DynamicValue){EASS_INT, 0, .value.i = best};
+    }
+    size_t index = 0;
+    while (data[index] != best) {
+        index++;
+    }
+    return _eass_reduce_index(index);
+}
+
+// Internal function to reduce a packed float array; NaN elements only win if all are NaN
+static DynamicValue _eass_reduce_floats(const DynamicArray* arr, EassReduceOp op) {
+    const float* data = arr->floats;
+    size_t n = arr->size;
+    if (op == EASS_REDUCE_SUM || op == EASS_REDUCE_MEAN) {
+        double total = _eass_sum_f32(data, n);
+        return (DynamicValue){EASS_FLOAT, 0, .value.f = (float)(op == EASS_REDUCE_MEAN ? total / (double)n : total)};
+    }
+    int want_max = (op == EASS_REDUCE_MAX || op == EASS_REDUCE_ARGMAX);
+    float best = _eass_extreme_f32(data, n, want_max);
+    size_t index = 0;
+    // Zeros of either sign compare equal, so min/max return the first one stored, as arrays of values do
+    if (op == EASS_REDUCE_ARGMIN || op == EASS_REDUCE_ARGMAX || isinf(best) || best == 0.0f) {
+        while (index < n && data[index] != best) {
+            index++;
+        }
+        if (index == n) {
+            index = 0; // Every element is NaN
+        }
+        best = data[index];
+    }
+    if (op == EASS_REDUCE_MIN || op == EASS_REDUCE_MAX) {
+        return (DynamicValue){EASS_FLOAT, 0, .value.f = best};
+    }
+    return _eass_reduce_index(index);
+}
+
+// Internal function to reduce an array of DynamicValues by dispatching on each tag; ints and floats
+// may be mixed and compare by value
+static DynamicValue _eass_reduce_values(const DynamicArray* arr, EassReduceOp op) {
+    int64_t int_total = 0;
+    double float_total = 0.0;
+    int any_float = 0;
+    int want_max = (op == EASS_REDUCE_MAX || op == EASS_REDUCE_ARGMAX);
+    size_t best_index = 0;
+    double best = NAN;
+    for (size_t i = 0; i < arr->size; i++) {
+        const DynamicValue* val = &arr->data[i];
+        double x;
+        if (val->error) {
+            return (DynamicValue){EASS_NULL, 1, .value.i = 0};
+        }
+        if (val->type == EASS_INT) {
+            int_total += val->value.i;
+            x = val->value.i;
+        } else if (val->type == EASS_FLOAT) {
+            float_total += val->value.f;
+            any_float = 1;
+            x = val->value.f;
+        } else {
+            _set_error(EINVAL, "array reduction found a non-numeric element");
+            return (DynamicValue){EASS_NULL, 1, .value.i = 0};
         }
+        if (isnan(best) ? !isnan(x) : (want_max ? x > best : x < best)) {
+            best = x;
+            best_index = i;
+        }
+    }
+    switch (op) {
+        case EASS_REDUCE_SUM:
+            if (!any_float) {
+                return _eass_reduce_int(int_total);
+            }
+            return (DynamicValue){EASS_FLOAT, 0, .value.f = (float)((double)int_total + float_total)};
+        case EASS_REDUCE_MEAN:
+            return (DynamicValue){EASS_FLOAT, 0, .value.f = (float)(((double)int_total + float_total) / (double)arr->size)};
+        case EASS_REDUCE_MIN:
+        case EASS_REDUCE_MAX:
+            return arr->data[best_index];
+        default:
+            return _eass_reduce_index(best_index);
+    }
+}
+
+// Internal function to check an array and run a reduction on it
+static DynamicValue _eass_array_reduce(const DynamicArray* arr, EassReduceOp op, const char* name) {
+    if (arr == NULL) {
+        char message[64];
+        snprintf(message, sizeof(message), "%s called with NULL array", name);
+        _set_error(EINVAL, message);
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0};
+    }
+    if (arr->error) {
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0};
+    }
+    if (arr->size == 0) {
+        if (op == EASS_REDUCE_SUM) {
+            return (DynamicValue){EASS_INT, 0, .value.i = 0};
+        }
+        char message[64];
+        snprintf(message, sizeof(message), "%s called on an empty array", name);
+        _set_error(EINVAL, message);
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0};
+    }
+    switch (arr->storage) {
+        case EASS_STORAGE_INT:
+            return _eass_reduce_ints(arr, op);
+        case EASS_STORAGE_FLOAT:
+            return _eass_reduce_floats(arr, op);
+        case EASS_STORAGE_VALUES:
+            return _eass_reduce_values(arr, op);
+        default:
+            _set_error(EINVAL, "array reduction found a non-numeric element");
+            return (DynamicValue){EASS_NULL, 1, .value.i = 0};
+    }
+}
+
+// Function to add up the numbers in an array: an EASS_INT if all are ints, otherwise an EASS_FLOAT
+DynamicValue array_sum(const DynamicArray* arr) {
+    return _eass_array_reduce(arr, EASS_REDUCE_SUM, "array_sum");
+}
+
+// Function to get the average of the numbers in an array as an EASS_FLOAT
+DynamicValue array_mean(const DynamicArray* arr) {
+    return _eass_array_reduce(arr, EASS_REDUCE_MEAN, "array_mean");
+}
+
+// Function to get the smallest number in an array
+DynamicValue array_min(const DynamicArray* arr) {
+    return _eass_array_reduce(arr, EASS_REDUCE_MIN, "array_min");
+}
+
+// Function to get the largest number in an array
+DynamicValue array_max(const DynamicArray* arr) {
+    return _eass_array_reduce(arr, EASS_REDUCE_MAX, "array_max");
+}
+
+// Function to get the index of the first smallest number in an array as an EASS_INT
+DynamicValue array_argmin(const DynamicArray* arr) {
+    return _eass_array_reduce(arr, EASS_REDUCE_ARGMIN, "array_argmin");
+}
+
+// Function to get the index of the first largest number in an array as an EASS_INT
+DynamicValue array_argmax(const DynamicArray* arr) {
+    return _eass_array_reduce(arr, EASS_REDUCE_ARGMAX, "array_argmax");
+}
+
+// Smallest array sorted by radix sort; shorter ones use insertion sort or introsort
+#ifndef EASS_SORT_RADIX_MIN
+#define EASS_SORT_RADIX_MIN 256
+#endif
+
+// Smallest array array_sort_parallel() splits across threads
+#ifndef EASS_SORT_PARALLEL_MIN
+#define EASS_SORT_PARALLEL_MIN 65536
+#endif
+
+// Comparison of two array elements of any storage
+typedef int (*EassElementCompare)(const void* a, const void* b, void* ctx);
+
+// How a run of array elements is sorted
+typedef enum {
+    EASS_SORT_COMPARE,      // Introsort with the comparison
+    EASS_SORT_INTS,         // Radix sort of packed ints
+    EASS_SORT_FLOATS,       // Radix sort of packed floats
+    EASS_SORT_INT_VALUES,   // Radix sort of DynamicValues that are all ints
+    EASS_SORT_FLOAT_VALUES  // Radix sort of DynamicValues that are all floats
+} EassSortKind;
+
+// A run of array elements and how to sort it
+typedef struct {
+    unsigned char* base;
+    size_t count;
+    size_t size; // Bytes per element
+    EassElementCompare compare;
+    void* ctx;
+    EassSortKind kind;
+} EassSortJob;
+
+// array_sort_by() comparison and the storage its elements are unpacked from
+typedef struct {
+    EassCompare compare;
+    void* ctx;
+    unsigned char storage;
+} EassSortUser;
+
+// Internal function to give a value its place in the order NULL < numbers < strings < arrays
+static int _eass_compare_rank(const DynamicValue* val) {
+    if (val->error) {
+        return 0;
+    }
+    switch (val->type) {
+        case EASS_INT:
+        case EASS_FLOAT:
+            return 1;
+        case EASS_STRING:
+            return string_value(val) ? 2 : 0; // A NULL string, e.g. from array_resize(), ranks as NULL
+        case EASS_STRVIEW:
+            return 2;
+        case EASS_ARRAY:
+            return 3;
+        default:
+            return 0;
+    }
+}
+
+// Internal function to compare two floats, putting NaN after every number
+static int _eass_compare_double(double a, double b) {
+    if (isnan(a) || isnan(b)) {
+        return isnan(a) - isnan(b);
+    }
+    return (a > b) - (a < b);
+}
+
+// Internal function to compare two byte strings, a shorter prefix first
+static int _eass_compare_bytes(const char* a, size_t a_len, const char* b, size_t b_len) {
+    int diff = a_len && b_len ? memcmp(a, b, a_len < b_len ? a_len : b_len) : 0; // Empty views may have NULL data
+    if (diff != 0) {
+        return diff < 0 ? -1 : 1;
+    }
+    return (a_len > b_len) - (a_len < b_len);
+}
+
+// Function to compare two values: NULL, NULL strings and errors sort first, then ints and floats by value (NaN
+// last), then strings and views byte by byte, then arrays element by element; returns a negative
+// number, zero or a positive number when a sorts before, together with or after b
+int value_compare(const DynamicValue* a, const DynamicValue* b) {
+    int rank = _eass_compare_rank(a);
+    int diff = rank - _eass_compare_rank(b);
+    if (diff != 0) {
+        return diff < 0 ? -1 : 1;
+    }
+    switch (rank) {
+        case 1:
+            if (a->type == EASS_INT && b->type == EASS_INT) {
+                return (a->value.i > b->value.i) - (a->value.i < b->value.i);
+            }
+            return _eass_compare_double(a->type == EASS_INT ? (double)a->value.i : (double)a->value.f,
+                                        b->type == EASS_INT ? (double)b->value.i : (double)b->value.f);
+        case 2: {
+            const char* a_text = a->type == EASS_STRING ? string_value(a) : EASS_VIEW_DATA(*a);
+            const char* b_text = b->type == EASS_STRING ? string_value(b) : EASS_VIEW_DATA(*b);
+            size_t a_len = a->type == EASS_STRING ? strlen(a_text) : EASS_VIEW_LENGTH(*a);
+            size_t b_len = b->type == EASS_STRING ? strlen(b_text) : EASS_VIEW_LENGTH(*b);
+            return _eass_compare_bytes(a_text, a_len, b_text, b_len);
+        }
+        case 3: {
+            const DynamicArray* x = EASS_ARRAY_OF(*a);
+            const DynamicArray* y = EASS_ARRAY_OF(*b);
+            size_t count = x->size < y->size ? x->size : y->size;
+            for (size_t i = 0; i < count; i++) {
+                DynamicValue x_tmp, y_tmp;
+                diff = value_compare(_eass_element(x->data, x->storage, i, &x_tmp),
+                                     _eass_element(y->data, y->storage, i, &y_tmp));
+                if (diff != 0) {
+                    return diff;
+                }
+            }
+            return (x->size > y->size) - (x->size < y->size);
+        }
+        default:
+            return 0;
+    }
+}
+
+// Internal function to compare packed ints
+static int _eass_sort_compare_int(const void* a, const void* b, void* ctx) {
+    (void)ctx;
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Internal function to compare packed floats
+static int _eass_sort_compare_float(const void* a, const void* b, void* ctx) {
+    (void)ctx;
+    return _eass_compare_double(*(const float*)a, *(const float*)b);
+}
+
+// Internal function to compare packed strings, putting NULL slots first
+static int _eass_sort_compare_string(const void* a, const void* b, void* ctx) {
+    const char* x = *(char* const*)a;
+    const char* y = *(char* const*)b;
+    (void)ctx;
+    if (x == NULL || y == NULL) {
+        return (x != NULL) - (y != NULL);
     }
+    return strcmp(x, y);
+}
 
-    arr.size = 0;
-    arr.capacity = initial_capacity;
-    arr.error = 0;
-    return arr;
+// Internal function to compare DynamicValue elements
+static int _eass_sort_compare_value(const void* a, const void* b, void* ctx) {
+    (void)ctx;
+    return value_compare((const DynamicValue*)a, (const DynamicValue*)b);
 }
 
-// Function to append an element to a dynamic array
-DynamicArray array_append(DynamicArray* arr, DynamicValue val) {
-    if (arr == NULL) {
-        _set_error(EINVAL, "array_append called with NULL array");
-        return (DynamicArray){NULL, 0, 0, 1};
+// Internal function to call an array_sort_by() comparison on elements of any storage
+static int _eass_sort_compare_user(const void* a, const void* b, void* ctx) {
+    const EassSortUser* user = (const EassSortUser*)ctx;
+    DynamicValue a_tmp, b_tmp;
+    return user->compare(_eass_element(a, user->storage, 0, &a_tmp), _eass_element(b, user->storage, 0, &b_tmp), user->ctx);
+}
+
+// Internal function to swap two array elements of size bytes; the common sizes get constant-size
+// copies the compiler can inline
+static inline void _eass_sort_swap(unsigned char* a, unsigned char* b, size_t size) {
+    unsigned char tmp[sizeof(DynamicValue)];
+    if (size == sizeof(DynamicValue)) {
+        memcpy(tmp, a, sizeof(DynamicValue));
+        memcpy(a, b, sizeof(DynamicValue));
+        memcpy(b, tmp, sizeof(DynamicValue));
+    } else if (size == sizeof(char*)) {
+        memcpy(tmp, a, sizeof(char*));
+        memcpy(a, b, sizeof(char*));
+        memcpy(b, tmp, sizeof(char*));
+    } else {
+        memcpy(tmp, a, size);
+        memcpy(a, b, size);
+        memcpy(b, tmp, size);
     }
-    if (arr->error) {
-        return *arr; // Return the array with the existing error
+}
+
+// Internal function to insertion sort count elements, for short runs
+static void _eass_insertion_sort(unsigned char* base, size_t count, size_t size, EassElementCompare compare, void* ctx) {
+    unsigned char tmp[sizeof(DynamicValue)];
+    for (size_t i = 1; i < count; i++) {
+        size_t j = i;
+        if (compare(base + (j - 1) * size, base + i * size, ctx) <= 0) {
+            continue;
+        }
+        memcpy(tmp, base + i * size, size);
+        do {
+            j--;
+        } while (j > 0 && compare(base + (j - 1) * size, tmp, ctx) > 0);
+        memmove(base + (j + 1) * size, base + j * size, (i - j) * size);
+        memcpy(base + j * size, tmp, size);
     }
-    if (arr->size >= arr->capacity) {
-        //int new_cap = (arr->capacity == 0) ? 4 : arr->capacity * 2; // original doubling
-        int new_cap = arr->capacity + (arr->capacity >> 1); // increase by 1.5x
-        if (new_cap < 4) new_cap = 4;
-#ifdef EASS_ENABLE_EMBEDDED
-        DynamicValue* new_data = (DynamicValue*)malloc(new_cap * sizeof(DynamicValue));
-        if (!new_data) {
-            _set_error(ENOMEM, "Realloc failed - embedded system");
-            arr->error = 1;
-            return *arr;
+}
+
+// Internal function to restore the heap below root in the first count elements
+static void _eass_sift_down(unsigned char* base, size_t root, size_t count, size_t size, EassElementCompare compare, void* ctx) {
+    for (;;) {
+        size_t child = 2 * root + 1;
+        if (child >= count) {
+            return;
         }
-        memcpy(new_data, arr->data, arr->size * sizeof(DynamicValue));
-        free(arr->data);
-        arr->data = new_data;
-        arr->capacity = new_cap;
-#else
-        DynamicValue* new_data = (DynamicValue*)realloc(arr->data, new_cap * sizeof(DynamicValue));
-        if (!new_data) {
-            _set_error(ENOMEM, "realloc failed in array_append");
-            arr->error = 1;
-            return *arr;
+        if (child + 1 < count && compare(base + child * size, base + (child + 1) * size, ctx) < 0) {
+            child++;
         }
-        arr->data = new_data;
-        arr->capacity = new_cap;
-#endif
+        if (compare(base + root * size, base + child * size, ctx) >= 0) {
+            return;
+        }
+        _eass_sort_swap(base + root * size, base + child * size, size);
+        root = child;
     }
-    arr->data[arr->size] = val;
-    arr->size++;
-    return *arr;
 }
 
-// Function to free the memory allocated for a dynamic array
-void free_dynamic_array(DynamicArray* arr) {
-    if (arr) {
-        for (size_t i = 0; i < arr->size; i++) {
-            free_dynamic_value(&arr->data[i]);
-        }
-        free(arr->data);
-        arr->data = NULL;
+// Internal function to heapsort count elements, for runs whose partitions keep coming out lopsided
+static void _eass_heap_sort(unsigned char* base, size_t count, size_t size, EassElementCompare compare, void* ctx) {
+    for (size_t i = count / 2; i-- > 0;) {
+        _eass_sift_down(base, i, count, size, compare, ctx);
+    }
+    for (size_t end = count - 1; end > 0; end--) {
+        _eass_sort_swap(base, base + end * size, size);
+        _eass_sift_down(base, 0, end, size, compare, ctx);
     }
 }
 
-// Function tofree the memory allocated for a DynamicValue
-void free_dynamic_value(DynamicValue* val) {
-    if (val) {
-        switch (val->type) {
-            case EASS_STRING:
-                if (val->value.s) free(val->value.s);
-                break;
-            case EASS_ARRAY:
-                free_dynamic_array(&val->value.a);
-                break;
-            // No need to free int or float
-            default:
-                break;
-        }
-        val->type = EASS_NULL; // Set type to NULL after freeing to prevent double freeing
+// Internal function to get the index of the middle one of three elements
+static size_t _eass_median3(unsigned char* base, size_t a, size_t b, size_t c, size_t size, EassElementCompare compare, void* ctx) {
+    if (compare(base + a * size, base + b * size, ctx) < 0) {
+        if (compare(base + b * size, base + c * size, ctx) < 0) return b;
+        return compare(base + a * size, base + c * size, ctx) < 0 ? c : a;
     }
+    if (compare(base + a * size, base + c * size, ctx) < 0) return a;
+    return compare(base + b * size, base + c * size, ctx) < 0 ? c : b;
 }
 
-// Function to format strings, similar to Python's format()
-char* string_format(const char* format, ...) {
-    va_list args;
-    va_start(args, format);
-    size_t formatted_length = 0;
-    size_t arg_count = 0;
-    const char* p = format;
-    int auto_index = 0; // For automatic indexing
-
-    // Calculate the length of the formatted string and count the number of arguments
-    while (*p != '\0') {
-        if (*p == '{' && *(p + 1) != '\0') {
-            if (*(p + 1) == '}') {
-                arg_count++;
-                p += 2;
-                 va_arg(args, DynamicValue);
-                formatted_length += 128; // Assume a max
-            }
-            else if (isdigit(*(p + 1)))
-            {
-                int index = strtol(p+1, NULL, 10);
-                arg_count = (index > arg_count) ? index : arg_count;
-                p += 3;
-                 va_arg(args, DynamicValue);
-                 formatted_length += 128;
-            }
-            else
-            {
-                 formatted_length++;
-                 p++;
+// Internal function to introsort count elements: quicksort around a median-of-three (ninther for
+// long runs) pivot, insertion sort below 16 elements and heapsort once depth runs out
+static void _eass_intro_sort(unsigned char* base, size_t count, size_t size, EassElementCompare compare, void* ctx, int depth) {
+    while (count > 16) {
+        if (depth-- == 0) {
+            _eass_heap_sort(base, count, size, compare, ctx);
+            return;
+        }
+        size_t mid = count / 2, last = count - 1;
+        size_t pivot;
+        if (count > 128) {
+            size_t step = count / 8;
+            pivot = _eass_median3(base,
+                                  _eass_median3(base, 0, step, 2 * step, size, compare, ctx),
+                                  _eass_median3(base, mid - step, mid, mid + step, size, compare, ctx),
+                                  _eass_median3(base, last - 2 * step, last - step, last, size, compare, ctx),
+                                  size, compare, ctx);
+        } else {
+            pivot = _eass_median3(base, 0, mid, last, size, compare, ctx);
+        }
+        _eass_sort_swap(base, base + pivot * size, size);
+
+        // Hoare partition around base[0]; both scans stop on equal elements so runs of
+        // duplicates split evenly
+        size_t i = 0, j = count;
+        for (;;) {
+            do {
+                i++;
+            } while (i < count && compare(base + i * size, base, ctx) < 0);
+            do {
+                j--;
+            } while (compare(base + j * size, base, ctx) > 0);
+            if (i >= j) {
+                break;
             }
+            _eass_sort_swap(base + i * size, base + j * size, size);
+        }
+        _eass_sort_swap(base, base + j * size, size);
+
+        // Recurse into the smaller side so the stack stays O(log n)
+        if (j < count - j - 1) {
+            _eass_intro_sort(base, j, size, compare, ctx, depth);
+            base += (j + 1) * size;
+            count -= j + 1;
         } else {
-            formatted_length++;
-            p++;
+            _eass_intro_sort(base + (j + 1) * size, count - j - 1, size, compare, ctx, depth);
+            count = j;
         }
     }
-    va_end(args);
+    _eass_insertion_sort(base, count, size, compare, ctx);
+}
 
-    // Allocate memory for the formatted string
-    char* formatted_string = (char*)malloc(formatted_length + 1); // +1 for null terminator
-    if (!formatted_string) {
-        _set_error(ENOMEM, "malloc failed in string_format");
-        return NULL;
+// Internal function to map a float to a key whose unsigned order is the float order, with NaN last
+static uint32_t _eass_float_key(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if (isnan(value)) {
+        bits &= 0x7FFFFFFFu;
     }
+    return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
 
-    // Reset va_list and arguments
-    va_start(args, format);
-    p = format;
-    char* out_p = formatted_string;
-    DynamicValue* arg_values = (DynamicValue*)malloc(sizeof(DynamicValue) * arg_count);
-     for (size_t i = 0; i < arg_count; i++) {
-        arg_values[i].type = EASS_NULL; // Initialize
+// Internal function to turn a key from _eass_float_key() back into its float
+static float _eass_float_from_key(uint32_t key) {
+    uint32_t bits = (key & 0x80000000u) ? (key & 0x7FFFFFFFu) : ~key;
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+// Internal function to sort 32-bit keys with an LSD radix sort, one byte per pass; passes where
+// every key has the same byte are skipped. scratch holds count keys; returns the sorted buffer.
+static uint32_t* _eass_radix_sort_keys(uint32_t* keys, uint32_t* scratch, size_t count) {
+    size_t counts[4][256] = {{0}};
+    for (size_t i = 0; i < count; i++) {
+        uint32_t key = keys[i];
+        counts[0][key & 0xFF]++;
+        counts[1][(key >> 8) & 0xFF]++;
+        counts[2][(key >> 16) & 0xFF]++;
+        counts[3][key >> 24]++;
+    }
+    for (int pass = 0; pass < 4; pass++) {
+        int shift = pass * 8;
+        if (counts[pass][(keys[0] >> shift) & 0xFF] == count) {
+            continue;
+        }
+        size_t offset = 0;
+        for (int b = 0; b < 256; b++) {
+            size_t n = counts[pass][b];
+            counts[pass][b] = offset;
+            offset += n;
+        }
+        for (size_t i = 0; i < count; i++) {
+            scratch[counts[pass][(keys[i] >> shift) & 0xFF]++] = keys[i];
+        }
+        uint32_t* swap = keys;
+        keys = scratch;
+        scratch = swap;
     }
-    int current_arg = 0;
+    return keys;
+}
 
-     while (*p != '\0') {
-        if (*p == '{' && *(p + 1) != '\0') {
-            if (*(p + 1) == '}') {
-                DynamicValue val = va_arg(args, DynamicValue);
-                if (current_arg < arg_count)
-                    arg_values[current_arg] = val;
-                p += 2;
-                current_arg++;
-                 if (val.error)
-                 {
-                     const EassError* error = eass_get_last_error();
-                     snprintf(out_p, formatted_length + 1, "Error: %d - %s", error->code, error->message);
-                     va_end(args);
-                     free(formatted_string);
-                     free(arg_values);
-                     return NULL;
-                 }
-                switch (val.type) {
-                    case EASS_INT:
-                        out_p += snprintf(out_p, formatted_length + 1 - (out_p - formatted_string), "%d", val.value.i);
-                        break;
-                    case EASS_FLOAT:
-                        out_p += snprintf(out_p, formatted_length + 1 - (out_p - formatted_string), "%f", val.value.f);
-                        break;
-                    case EASS_STRING:
-                        out_p += snprintf(out_p, formatted_length + 1 - (out_p - formatted_string), "%s", val.value.s);
-                        break;
-                    case EASS_ARRAY:
-                        out_p += snprintf(out_p, formatted_length + 1 - (out_p - formatted_string), "Array[");
-                        for (size_t i = 0; i < val.value.a.size; ++i)
-                        {
-                            DynamicValue element = val.value.a.data[i];
-                             if (element.error)
-                             {
-                                 const EassError* error = eass_get_last_error();
-                                 snprintf(out_p, formatted_length + 1 - (out_p - formatted_string), "Error: %d - %s", error->code, error->message);
-                                 va_end(args);
-                                 free(formatted_string);
-                                 free(arg_values);
-                                 return NULL;
-                             }
-                            if (element.type == EASS_INT)
-                                out_p += snprintf(out_p, formatted_length + 1 - (out_p - formatted_string), "%d", element.value.i);
-                            else if (element.type == EASS_FLOAT)
-                                out_p += snprintf(out_p, formatted_length + 1 - (out_p - formatted_string), "%f", element.value.f);
-                            else if (element.type == EASS_STRING)
-                                out_p += snprintf(out_p, formatted_length + 1 - (out_p - formatted_string), "%s", element.value.s);
-
-                            if (i < val.value.a.size - 1)
-                                out_p += snprintf(out_p, formatted_length + 1 - (out_p - formatted_string), ", ");
-                        }
-                        out_p += snprintf(out_p, formatted_length + 1 - (out_p - formatted_string), "]");
-                        break;
-                    case EASS_NULL:
-                        out_p += snprintf(out_p, formatted_length + 1 - (out_p - formatted_string), "NULL");
-                        break;
-                }
-               // free_dynamic_value(&val);
-            }
-            else if (isdigit(*(p+1)))
-            {
-                 int index = strtol(p+1, NULL, 10);
-                 DynamicValue val = arg_values[index];
-                  p+=3;
-                  if (val.error)
-                 {
-                     const EassError* error = eass_get_last_error();
-                     snprintf(out_p, formatted_length + 1, "Error: %d - %s", error->code, error->message);
-                     va_end(args);
-                     free(formatted_string);
-                      free(arg_values);
-                     return NULL;
-                 }
-                  switch (val.type) {
-                    case EASS_INT:
-                        out_p += snprintf(out_p, formatted_length + 1 - (out_p - formatted_string), "%d", val.value.i);
-                        break;
-                    case EASS_FLOAT:
-                        out_p += snprintf(out_p, formatted_length + 1 - (out_p - formatted_string), "%f", val.value.f);
-                        break;
-                    case EASS_STRING:
-                        out_p += snprintf(out_p, formatted_length + 1 - (out_p - formatted_string), "%s", val.value.s);
-                        break;
-                    case EASS_ARRAY:
-                        out_p += snprintf(out_p, formatted_length + 1 - (out_p - formatted_string), "Array[");
-                        for (size_t i = 0; i < val.value.a.size; ++i)
-                        {
-                            DynamicValue element = val.value.a.data[i];
-                             if (element.error)
-                             {
-                                  const EassError* error = eass_get_last_error();
-                                 snprintf(out_p, formatted_length + 1 - (out_p - formatted_string), "Error: %d - %s", error->code, error->message);
-                                 va_end(args);
-                                 free(formatted_string);
-                                  free(arg_values);
-                                 return NULL;
-                             }
-                            if (element.type == EASS_INT)
-                                out_p += snprintf(out_p, formatted_length + 1 - (out_p - formatted_string), "%d", element.value.i);
-                            else if (element.type == EASS_FLOAT)
-                                out_p += snprintf(out_p, formatted_length + 1 - (out_p - formatted_string), "%f", element.value.f);
-                            else if (element.type == EASS_STRING)
-                                out_p += snprintf(out_p, formatted_length + 1 - (out_p - formatted_string), "%s", element.value.s);
-
-                            if (i < val.value.a.size - 1)
-                                out_p += snprintf(out_p, formatted_length + 1 - (out_p - formatted_string), ", ");
-                        }
-                        out_p += snprintf(out_p, formatted_length + 1 - (out_p - formatted_string), "]");
-                        break;
-                    case EASS_NULL:
-                        out_p += snprintf(out_p, formatted_length + 1 - (out_p - formatted_string), "NULL");
-                        break;
-                }
-            }
-            else
-            {
-                 *out_p++ = *p++;
-            }
-        } else {
-            *out_p++ = *p++;
+// Internal function to radix sort a run of ints or floats, packed or as DynamicValues; returns -1
+// if the key buffers cannot be allocated
+static int _eass_radix_sort(const EassSortJob* job) {
+    size_t count = job->count;
+    uint32_t* keys = (uint32_t*)malloc(2 * count * sizeof(uint32_t));
+    if (!keys) {
+        return -1;
+    }
+    int* ints = (int*)job->base;
+    float* floats = (float*)job->base;
+    DynamicValue* values = (DynamicValue*)job->base;
+    for (size_t i = 0; i < count; i++) {
+        switch (job->kind) {
+            case EASS_SORT_INTS:
+                keys[i] = (uint32_t)ints[i] ^ 0x80000000u;
+                break;
+            case EASS_SORT_FLOATS:
+                keys[i] = _eass_float_key(floats[i]);
+                break;
+            case EASS_SORT_INT_VALUES:
+                keys[i] = (uint32_t)values[i].value.i ^ 0x80000000u;
+                break;
+            default:
+                keys[i] = _eass_float_key(values[i].value.f);
+                break;
         }
     }
-    *out_p = '\0'; // Null terminate the string
-    va_end(args);
-     for (size_t i = 0; i < arg_count; i++) {
-        free_dynamic_value(&arg_values[i]);
+    uint32_t* sorted = _eass_radix_sort_keys(keys, keys + count, count);
+    for (size_t i = 0; i < count; i++) {
+        switch (job->kind) {
+            case EASS_SORT_INTS:
+                ints[i] = (int)((int64_t)sorted[i] - INT64_C(0x80000000));
+                break;
+            case EASS_SORT_FLOATS:
+                floats[i] = _eass_float_from_key(sorted[i]);
+                break;
+            case EASS_SORT_INT_VALUES:
+                values[i] = (DynamicValue){EASS_INT, 0, .value.i = (int)((int64_t)sorted[i] - INT64_C(0x80000000))};
+                break;
+            default:
+                values[i] = (DynamicValue){EASS_FLOAT, 0, .value.f = _eass_float_from_key(sorted[i])};
+                break;
+        }
     }
-    free(arg_values);
-    return formatted_string;
+    free(keys);
+    return 0;
 }
 
-// Function to read the entire content of a file into a string
-char* read_file(const char* filename) {
-    FILE* file = fopen(filename, "rb");
-    if (!file) {
-        _set_error(errno, "fopen failed in read_file");
-        return NULL;
+// Internal function to sort one run; long numeric runs use radix sort, falling back to introsort
+// when there is no memory for the keys
+static void _eass_sort_run(const EassSortJob* job) {
+    if (job->kind != EASS_SORT_COMPARE && job->count >= EASS_SORT_RADIX_MIN && _eass_radix_sort(job) == 0) {
+        return;
     }
-
-    fseek(file, 0, SEEK_END);
-    long file_size = ftell(file);
-    if (file_size == -1) {
-        _set_error(errno, "ftell failed in read_file");
-        fclose(file);
-        return NULL;
+    int depth = 0;
+    for (size_t n = job->count; n > 1; n >>= 1) {
+        depth += 2;
     }
-    fseek(file, 0, SEEK_SET);
+    _eass_intro_sort(job->base, job->count, job->size, job->compare, job->ctx, depth);
+}
 
-    char* buffer = (char*)malloc(file_size + 1);
-    if (!buffer) {
-        _set_error(ENOMEM, "malloc failed in read_file");
-        fclose(file);
-        return NULL;
+// Internal function to describe how array_sort() sorts an array
+static EassSortJob _eass_sort_plan(DynamicArray* arr) {
+    EassSortJob job = {(unsigned char*)arr->data, arr->size, _eass_storage_size(arr->storage), _eass_sort_compare_value, NULL, EASS_SORT_COMPARE};
+    switch (arr->storage) {
+        case EASS_STORAGE_INT:
+            job.compare = _eass_sort_compare_int;
+            job.kind = EASS_SORT_INTS;
+            break;
+        case EASS_STORAGE_FLOAT:
+            job.compare = _eass_sort_compare_float;
+            job.kind = EASS_SORT_FLOATS;
+            break;
+        case EASS_STORAGE_STRING:
+        case EASS_STORAGE_INTERNED:
+            job.compare = _eass_sort_compare_string;
+            break;
+        default: {
+            // Arrays of DynamicValues that hold only ints or only floats can be radix sorted too
+            size_t ints = 0, floats = 0;
+            for (size_t i = 0; i < arr->size && !arr->data[i].error; i++) {
+                if (arr->data[i].type == EASS_INT) ints++;
+                else if (arr->data[i].type == EASS_FLOAT) floats++;
+                else break;
+            }
+            if (ints == arr->size) job.kind = EASS_SORT_INT_VALUES;
+            else if (floats == arr->size) job.kind = EASS_SORT_FLOAT_VALUES;
+            break;
+        }
     }
+    return job;
+}
 
-    size_t bytes_read = fread(buffer, 1, file_size, file);
-    if (bytes_read != file_size) {
-        _set_error(errno, "fread failed in read_file");
-        fclose(file);
-        free(buffer);
-        return NULL;
+// Function to sort an array in the order of value_compare(); packed int and float arrays, and
+// arrays that hold only ints or only floats, are radix sorted. The sort is not stable. Returns 0
+// on success and -1 on error.
+int array_sort(DynamicArray* arr) {
+    if (arr == NULL) {
+        _set_error(EINVAL, "array_sort called with NULL array");
+        return -1;
     }
-    buffer[file_size] = '\0'; // Null terminate
-
-    fclose(file);
-    return buffer;
+    if (arr->error) {
+        return -1;
+    }
+    EassSortJob job = _eass_sort_plan(arr);
+    _eass_sort_run(&job);
+    return 0;
 }
 
-// Function to write a string to a file
-int write_file(const char* filename, const char* content) {
-    FILE* file = fopen(filename, "wb");
-    if (!file) {
-        _set_error(errno, "fopen failed in write_file");
+// Function to sort an array with a comparison function that gets ctx as its last argument; packed
+// elements are passed as temporary DynamicValues. The sort is not stable. Returns 0 on success and
+// -1 on error.
+int array_sort_by(DynamicArray* arr, EassCompare compare, void* ctx) {
+    if (arr == NULL || compare == NULL) {
+        _set_error(EINVAL, "array_sort_by called with NULL array or comparison");
         return -1;
     }
-
-    size_t content_length = strlen(content);
-    size_t bytes_written = fwrite(content, 1, content_length, file);
-    if (bytes_written != content_length) {
-        _set_error(errno, "fwrite failed in write_file");
-        fclose(file);
+    if (arr->error) {
         return -1;
     }
-
-    fclose(file);
+    EassSortUser user = {compare, ctx, arr->storage};
+    EassSortJob job = {(unsigned char*)arr->data, arr->size, _eass_storage_size(arr->storage), _eass_sort_compare_user, &user, EASS_SORT_COMPARE};
+    _eass_sort_run(&job);
     return 0;
 }
 
-// Function to get the current time in seconds
-double get_time_in_seconds() {
-#ifdef _WIN32
-    // Use GetTickCount64 on Windows
-    DWORD64 ticks = GetTickCount64();
-    return (double)ticks / 1000.0; // Convert milliseconds to seconds
-#else
-    // Use gettimeofday on Linux/macOS
-    struct timeval tv;
-    if (gettimeofday(&tv, NULL) != 0) {
-        _set_error(errno, "gettimeofday failed in get_time_in_seconds");
-        return 0.0; // Return 0.0 on error, or handle the error as appropriate for your application
-    }
-    return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0; // Convert to seconds
-#endif
+#ifdef EASS_HAS_THREADS
+// Internal thread function sorting one run for array_sort_parallel()
+static int _eass_sort_thread(void* arg) {
+    _eass_sort_run((const EassSortJob*)arg);
+    return 0;
 }
+#endif
 
-// Function to insert a value into a dynamic array at a specified index
-DynamicArray array_insert(DynamicArray* arr, size_t index, DynamicValue val) {
+// Function to sort an array like array_sort(), splitting arrays of at least EASS_SORT_PARALLEL_MIN
+// elements into one run per thread and merging the sorted runs; without C11 threads, or when
+// memory runs short, it sorts on the calling thread. Returns 0 on success and -1 on error.
+int array_sort_parallel(DynamicArray* arr, int threads) {
     if (arr == NULL) {
-        _set_error(EINVAL, "array_insert called with NULL array");
-        return (DynamicArray){NULL, 0, 0, 1};
+        _set_error(EINVAL, "array_sort_parallel called with NULL array");
+        return -1;
     }
     if (arr->error) {
-        return *arr; // Return the array with the existing error
+        return -1;
     }
-    if (index > arr->size) {
-        _set_error(EINVAL, "Index out of bounds in array_insert");
-        return *arr;
+#ifdef EASS_HAS_THREADS
+    enum { EASS_SORT_MAX_THREADS = 64 };
+    if (threads > EASS_SORT_MAX_THREADS) threads = EASS_SORT_MAX_THREADS;
+    if (threads < 2 || arr->size < EASS_SORT_PARALLEL_MIN) {
+        return array_sort(arr);
+    }
+    EassSortJob whole = _eass_sort_plan(arr);
+    size_t size = whole.size;
+    unsigned char* scratch = (unsigned char*)malloc(arr->size * size);
+    if (!scratch) {
+        return array_sort(arr);
     }
 
-    if (arr->size >= arr->capacity) {
-        size_t new_cap = (arr->capacity == 0) ? 4 : arr->capacity * 2;
-#ifdef EASS_ENABLE_EMBEDDED
-        DynamicValue* new_data = (DynamicValue*)malloc(new_cap * sizeof(DynamicValue));
-        if (!new_data) {
-            _set_error(ENOMEM, "malloc failed in array_insert (embedded)");
-            arr->error = 1;
-            return *arr;
+    // Sort one run per thread, the last on this thread
+    EassSortJob jobs[EASS_SORT_MAX_THREADS];
+    thrd_t workers[EASS_SORT_MAX_THREADS];
+    int started[EASS_SORT_MAX_THREADS];
+    size_t bounds[EASS_SORT_MAX_THREADS + 1];
+    for (int t = 0; t <= threads; t++) {
+        bounds[t] = arr->size / (size_t)threads * (size_t)t + (t == threads ? arr->size % (size_t)threads : 0);
+    }
+    for (int t = 0; t < threads; t++) {
+        jobs[t] = whole;
+        jobs[t].base = whole.base + bounds[t] * size;
+        jobs[t].count = bounds[t + 1] - bounds[t];
+        started[t] = t < threads - 1 && thrd_create(&workers[t], _eass_sort_thread, &jobs[t]) == thrd_success;
+    }
+    _eass_sort_run(&jobs[threads - 1]);
+    for (int t = 0; t < threads - 1; t++) {
+        if (started[t]) {
+            thrd_join(workers[t], NULL);
+        } else {
+            _eass_sort_run(&jobs[t]);
         }
-        memcpy(new_data, arr->data, index * sizeof(DynamicValue));
-        memcpy(new_data + index + 1, arr->data + index, (arr->size - index) * sizeof(DynamicValue));
-        free(arr->data);
-        arr->data = new_data;
-        arr->capacity = new_cap;
-#else
-        DynamicValue* new_data = (DynamicValue*)realloc(arr->data, new_cap * sizeof(DynamicValue));
-        if (!new_data) {
-            _set_error(ENOMEM, "realloc failed in array_insert");
-            arr->error = 1;
-            return *arr;
+    }
+
+    // Merge neighbouring runs until one is left, moving between the array and scratch
+    unsigned char* from = whole.base;
+    unsigned char* to = scratch;
+    for (int runs = threads; runs > 1; runs = (runs + 1) / 2) {
+        int merged = 0;
+        for (int r = 0; r < runs; r += 2, merged++) {
+            size_t lo = bounds[r], mid = bounds[r + 1 < runs ? r + 1 : runs], hi = bounds[r + 2 < runs ? r + 2 : runs];
+            size_t a = lo, b = mid, out = lo;
+            while (a < mid && b < hi) {
+                size_t pick = whole.compare(from + b * size, from + a * size, whole.ctx) < 0 ? b++ : a++;
+                memcpy(to + out++ * size, from + pick * size, size);
+            }
+            memcpy(to + out * size, from + a * size, (mid - a) * size);
+            out += mid - a;
+            memcpy(to + out * size, from + b * size, (hi - b) * size);
+            bounds[merged] = lo;
         }
-        arr->data = new_data;
-        arr->capacity = new_cap;
+        bounds[merged] = arr->size;
+        unsigned char* swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from != whole.base) {
+        memcpy(whole.base, from, arr->size * size);
+    }
+    free(scratch);
+    return 0;
+#else
+    (void)threads;
+    return array_sort(arr);
 #endif
-    } else {
-        // Make space for the new element
-        for (size_t i = arr->size; i > index; i--) {
-            arr->data[i] = arr->data[i - 1];
+}
+
+// Internal function to round a deque capacity up to a power of two, at least 4; 0 on overflow
+static size_t _eass_deque_round(size_t capacity) {
+    size_t rounded = 4;
+    while (rounded < capacity) {
+        if (rounded > SIZE_MAX / 2 / sizeof(DynamicValue)) {
+            return 0;
         }
+        rounded *= 2;
     }
+    return rounded;
+}
 
-    arr->data[index] = val;
-    arr->size++;
-    return *arr;
+// Function to create a new double-ended queue with room for at least initial_capacity elements
+DynamicDeque deque(size_t initial_capacity) {
+    DynamicDeque dq = {NULL, 0, 0, 0, 0};
+    if (initial_capacity == 0) {
+        return dq;
+    }
+    size_t capacity = _eass_deque_round(initial_capacity);
+    dq.data = capacity ? (DynamicValue*)malloc(capacity * sizeof(DynamicValue)) : NULL;
+    if (dq.data == NULL) {
+        _set_error(ENOMEM, "malloc failed in deque");
+        dq.error = 1;
+        return dq;
+    }
+    dq.capacity = capacity;
+    return dq;
 }
 
-// Function to remove an element from a dynamic array at a specified index
-DynamicValue array_remove(DynamicArray* arr, size_t index) {
-    if (arr == NULL) {
-        _set_error(EINVAL, "array_remove called with NULL array");
-        return (DynamicValue){EASS_NULL, 1, .value.i = 0}; // Return a default invalid DynamicValue
+// Internal function to double the ring of a full deque; returns -1 on error
+static int _eass_deque_grow(DynamicDeque* dq) {
+    size_t old_cap = dq->capacity;
+    size_t new_cap = _eass_deque_round(old_cap + 1);
+    if (new_cap == 0) {
+        _set_error(EOVERFLOW, "deque capacity too large");
+        return -1;
     }
-    if (arr->error) {
-        return (DynamicValue){EASS_NULL, 1, .value.i = 0}; // Return a default invalid DynamicValue
+    DynamicValue* data = (DynamicValue*)_eass_realloc(dq->data, old_cap * sizeof(DynamicValue), new_cap * sizeof(DynamicValue));
+    if (!data) {
+        _set_error(ENOMEM, "realloc failed growing a deque");
+        return -1;
     }
-    if (index >= arr->size) {
-        _set_error(EINVAL, "Index out of bounds in array_remove");
-        return (DynamicValue){EASS_NULL, 1, .value.i = 0}; // Return a default invalid DynamicValue
+    // The elements that wrapped to the start of the old ring now follow its end
+    if (dq->head + dq->size > old_cap) {
+        memcpy(data + old_cap, data, (dq->head + dq->size - old_cap) * sizeof(DynamicValue));
     }
+    dq->data = data;
+    dq->capacity = new_cap;
+    return 0;
+}
+
+// Function to add a value after the last element of a deque in O(1); returns 0 on success and -1 on error
+int deque_push_back(DynamicDeque* dq, DynamicValue val) {
+    if (dq == NULL) {
+        _set_error(EINVAL, "deque_push_back called with NULL deque");
+        return -1;
+    }
+    if (dq->error || (dq->size == dq->capacity && _eass_deque_grow(dq) != 0)) {
+        return -1;
+    }
+    dq->data[(dq->head + dq->size) & (dq->capacity - 1)] = val;
+    dq->size++;
+    return 0;
+}
 
-    DynamicValue removed_val = arr->data[index]; // Copy the value to be removed
+// Function to add a value before the first element of a deque in O(1); returns 0 on success and -1 on error
+int deque_push_front(DynamicDeque* dq, DynamicValue val) {
+    if (dq == NULL) {
+        _set_error(EINVAL, "deque_push_front called with NULL deque");
+        return -1;
+    }
+    if (dq->error || (dq->size == dq->capacity && _eass_deque_grow(dq) != 0)) {
+        return -1;
+    }
+    dq->head = (dq->head - 1) & (dq->capacity - 1);
+    dq->data[dq->head] = val;
+    dq->size++;
+    return 0;
+}
 
-    // Shift elements to fill the gap
-    for (size_t i = index; i < arr->size - 1; i++) {
-        arr->data[i] = arr->data[i + 1];
+// Function to take the last element of a deque; the caller owns the returned value
+DynamicValue deque_pop_back(DynamicDeque* dq) {
+    if (dq == NULL) {
+        _set_error(EINVAL, "deque_pop_back called with NULL deque");
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0};
+    }
+    if (dq->error) {
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0};
+    }
+    if (dq->size == 0) {
+        _set_error(EINVAL, "deque_pop_back called on an empty deque");
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0};
     }
+    dq->size--;
+    return dq->data[(dq->head + dq->size) & (dq->capacity - 1)];
+}
 
-    arr->size--;
-    return removed_val; // Return the removed value
+// Function to take the first element of a deque; the caller owns the returned value
+DynamicValue deque_pop_front(DynamicDeque* dq) {
+    if (dq == NULL) {
+        _set_error(EINVAL, "deque_pop_front called with NULL deque");
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0};
+    }
+    if (dq->error) {
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0};
+    }
+    if (dq->size == 0) {
+        _set_error(EINVAL, "deque_pop_front called on an empty deque");
+        return (DynamicValue){EASS_NULL, 1, .value.i = 0};
+    }
+    DynamicValue val = dq->data[dq->head];
+    dq->head = (dq->head + 1) & (dq->capacity - 1);
+    dq->size--;
+    return val;
 }
 
-// Function to get an element from a dynamic array at a specified index
-DynamicValue array_get(const DynamicArray* arr, size_t index) {
-    if (arr == NULL) {
-        _set_error(EINVAL, "array_get called with NULL array");
+// Function to get the element at a position counted from the front of a deque, like array_get()
+DynamicValue deque_get(const DynamicDeque* dq, size_t index) {
+    if (dq == NULL) {
+        _set_error(EINVAL, "deque_get called with NULL deque");
         return (DynamicValue){EASS_NULL, 1, .value.i = 0};
     }
-    if (arr->error) {
+    if (dq->error) {
         return (DynamicValue){EASS_NULL, 1, .value.i = 0};
     }
-    if (index >= arr->size) {
-        _set_error(EINVAL, "Index out of bounds in array_get");
+    if (index >= dq->size) {
+        _set_error(EINVAL, "Index out of bounds in deque_get");
         return (DynamicValue){EASS_NULL, 1, .value.i = 0};
     }
+    return dq->data[(dq->head + index) & (dq->capacity - 1)];
+}
 
-    return arr->data[index];
+// Function to free a deque and the elements it still holds
+void free_dynamic_deque(DynamicDeque* dq) {
+    if (dq) {
+        for (size_t i = 0; i < dq->size; i++) {
+            free_dynamic_value(&dq->data[(dq->head + i) & (dq->capacity - 1)]);
+        }
+        free(dq->data);
+        dq->data = NULL;
+        dq->head = 0;
+        dq->size = 0;
+        dq->capacity = 0;
+    }
 }
 
 #ifdef EASS_DEBUG_MEMORY
@@ -0,0 +1,630 @@
+// Regression checks for eass.h
+//
+// Each check prints a line when it fails; the exit status is the number of failures.
+//
+// Usage: eass_check
+// Build: cc -std=c11 -O1 -I.. eass_check.c -o eass_check -pthread -lm
+//        (add -DEASS_COMPACT_VALUES to check the compact value layout)
+#include <stdlib.h>
+
+// Number of malloc() calls to let through before one fails; -1 never fails. Only changed while a
+// single thread runs the library.
+static long check_malloc_countdown = -1;
+
+static void* check_malloc(size_t size) {
+    if (check_malloc_countdown == 0) {
+        check_malloc_countdown = -1;
+        return NULL;
+    }
+    if (check_malloc_countdown > 0) {
+        check_malloc_countdown--;
+    }
+    return malloc(size);
+}
+
+#define malloc(size) check_malloc(size)
+#include "eass.h"
+
+static int check_failures;
+static int check_count;
+
+#define CHECK(cond) check_true((cond), #cond, __FILE__, __LINE__)
+
+static void check_true(int ok, const char* what, const char* file, int line) {
+    check_count++;
+    if (!ok) {
+        check_failures++;
+        fprintf(stderr, "%s:%d: check failed: %s\n", file, line, what);
+    }
+}
+
+// Function to check that a formatted string matches and free it
+static void check_format(char* got, const char* want, const char* file, int line) {
+    check_count++;
+    if (!got || strcmp(got, want) != 0) {
+        check_failures++;
+        fprintf(stderr, "%s:%d: got \"%s\", want \"%s\"\n", file, line, got ? got : "(null)", want);
+    }
+    free(got);
+}
+
+#define CHECK_FORMAT(got, want) check_format((got), (want), __FILE__, __LINE__)
+
+static void check_format_specs(void) {
+    CHECK_FORMAT(string_format("{:08.3f}", numlit(3.14159f)), "0003.142");
+    CHECK_FORMAT(string_format("{:x} {:#X} {:b}", numlit(255), numlit(255), numlit(5)), "ff 0XFF 101");
+    CHECK_FORMAT(string_format("[{:>8}] [{:<8}] [{:*^8}]", numlit(1), numlit(2), numlit(3)), "[       1] [2       ] [***3****]");
+    CHECK_FORMAT(string_format("{:+d} {:.1%}", numlit(5), numlit(0.256f)), "+5 25.6%");
+    CHECK_FORMAT(string_format("{:.0%}", numlit(1)), "100%");
+
+    // Percentages longer than the stack buffer of _eass_spec_float()
+    for (int precision = 505; precision <= 520; precision++) {
+        char format[24];
+        snprintf(format, sizeof(format), "{:.%d%%}", precision);
+        char* got = string_format(format, numlit(0.5));
+        CHECK(got != NULL && strlen(got) == (size_t)precision + 4 && strncmp(got, "50.000", 6) == 0 &&
+              got[precision + 3] == '%');
+        free(got);
+    }
+    char* wide = string_format("{:>700.600%}", numlit(-0.25));
+    CHECK(wide != NULL && strlen(wide) == 700 && strstr(wide, "-25.000") != NULL && wide[699] == '%');
+    free(wide);
+
+    // A format buffer reused with new text must not get the cached template of the old text
+    char reused[32];
+    char line[32];
+    snprintf(reused, sizeof(reused), "A={} B={}");
+    CHECK_FORMAT(string_format(reused, numlit(1), numlit(2)), "A=1 B=2");
+    snprintf(reused, sizeof(reused), "x{}");
+    CHECK_FORMAT(string_format(reused, numlit(1)), "x1");
+    snprintf(reused, sizeof(reused), "A={} B={}");
+    print_buf(line, sizeof(line), reused, numlit(1), numlit(2));
+    snprintf(reused, sizeof(reused), "x{}");
+    print_buf(line, sizeof(line), reused, numlit(1));
+    CHECK(strncmp(line, "x1", 2) == 0);
+}
+
+static void check_sinks(void) {
+    EassSink log = eass_sink_memory();
+    print_sink(&log, "request {} took {} ms", numlit(42), numlit(3.5f));
+    print_sink(&log, "request {} took {} ms", numlit(43), strlit("a string too long to be kept inline"));
+    CHECK(log.data != NULL && log.size == strlen(log.data));
+    CHECK(log.data != NULL && strcmp(log.data, "request 42 took 3.5 ms\nrequest 43 took a string too long to be kept inline ms\n") == 0);
+    eass_sink_free(&log);
+
+    // Buffers keep what fits and count the rest, like snprintf()
+    char small[8];
+    CHECK(print_buf(small, sizeof(small), "{}-{}", strlit("abcdef"), numlit(12345)) == 13);
+    CHECK(strcmp(small, "abcdef-") == 0);
+    char fixed[64];
+    EassSink buffer = eass_sink_buffer(fixed, sizeof(fixed));
+    print_sink(&buffer, "{} {}", numlit(1), numlit(2));
+    print_sink(&buffer, "{}", strview("view text", 4));
+    CHECK(buffer.total == 9 && strcmp(fixed, "1 2\nview\n") == 0);
+
+    EassStr text = eass_str();
+    EassSink builder = eass_sink_str(&text);
+    print_sink(&builder, "[{:>4}]", numlit(7));
+    CHECK(strcmp(eass_str_cstr(&text), "[   7]\n") == 0);
+    eass_str_free(&text);
+
+    FILE* file = tmpfile();
+    if (file) {
+        print_to(file, "to {}", strlit("file"));
+        char line[32] = "";
+        rewind(file);
+        CHECK(fgets(line, sizeof(line), file) != NULL && strcmp(line, "to file\n") == 0);
+        fclose(file);
+    }
+#if defined(__linux__) || defined(__APPLE__)
+    int fds[2];
+    if (pipe(fds) == 0) {
+        print_fd(fds[1], "fd {} {}", numlit(3), numlit(-4));
+        char line[32] = "";
+        ssize_t got = read(fds[0], line, sizeof(line) - 1);
+        CHECK(got == 8 && strcmp(line, "fd 3 -4\n") == 0);
+        close(fds[0]);
+        close(fds[1]);
+    }
+#endif
+
+    // Error lines carry the whole message, which may be longer than a short stack buffer
+    char message[201];
+    memset(message, 'm', 200);
+    message[200] = '\0';
+    _set_error(EINVAL, message);
+    log = eass_sink_memory();
+    print_sink(&log, "value {}", (DynamicValue){EASS_NULL, 1, .value.i = 0});
+    char want[256];
+    snprintf(want, sizeof(want), "value Error: %d - %s", EINVAL, message);
+    CHECK(log.data != NULL && strncmp(log.data, want, strlen(want)) == 0);
+    eass_sink_free(&log);
+}
+
+#if defined(EASS_HAS_ASYNC) && (defined(__linux__) || defined(__APPLE__))
+enum { CHECK_ASYNC_THREADS = 3, CHECK_ASYNC_LINES = 300 };
+
+static int check_async_worker(void* arg) {
+    int id = *(const int*)arg;
+    for (int i = 0; i < CHECK_ASYNC_LINES; i++) {
+        if (i % 50 == 0) {
+            print("t{} line {} {:x>600}", numlit(id), numlit(i), strlit("")); // Takes several slots
+        } else {
+            print("t{} line {}", numlit(id), numlit(i));
+        }
+    }
+    return 0;
+}
+
+static void check_async(void) {
+    FILE* capture = tmpfile();
+    if (!capture) {
+        return;
+    }
+    // The background thread writes to descriptor 1, so point it at the file for a while
+    eass_flush();
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    dup2(fileno(capture), STDOUT_FILENO);
+    print("before");
+    CHECK(eass_async_start(4, EASS_ASYNC_BLOCK) == 0); // Small enough that producers wait for room
+    thrd_t threads[CHECK_ASYNC_THREADS];
+    int ids[CHECK_ASYNC_THREADS];
+    for (int t = 0; t < CHECK_ASYNC_THREADS; t++) {
+        ids[t] = t;
+        thrd_create(&threads[t], check_async_worker, &ids[t]);
+    }
+    for (int i = 0; i < 50; i++) {
+        _eass_async_drain(); // What input() does; must return while other threads keep printing
+    }
+    for (int t = 0; t < CHECK_ASYNC_THREADS; t++) {
+        thrd_join(threads[t], NULL);
+    }
+    print("after");
+    eass_async_stop();
+    print("stopped");
+    eass_flush();
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+
+    // Every line arrives whole, and each thread's lines arrive in order
+    int next[CHECK_ASYNC_THREADS] = {0};
+    int lines = 0, broken = 0;
+    char line[1024];
+    rewind(capture);
+    while (fgets(line, sizeof(line), capture)) {
+        int t, n;
+        lines++;
+        if (lines == 1) {
+            CHECK(strcmp(line, "before\n") == 0);
+        } else if (sscanf(line, "t%d line %d", &t, &n) == 2 && t >= 0 && t < CHECK_ASYNC_THREADS) {
+            broken += n != next[t] || (n % 50 == 0 && strlen(line) < 600);
+            next[t] = n + 1;
+        } else if (strcmp(line, "after\n") != 0 && strcmp(line, "stopped\n") != 0) {
+            broken++;
+        }
+    }
+    CHECK(lines == CHECK_ASYNC_THREADS * CHECK_ASYNC_LINES + 3 && broken == 0);
+    CHECK(strcmp(line, "stopped\n") == 0);
+    CHECK(eass_async_dropped() == 0);
+    fclose(capture);
+}
+#endif
+
+// Function to count the lines of decoded binary log text that read want after their timestamp
+static int check_count_records(const char* text, const char* want) {
+    int found = 0;
+    size_t want_len = strlen(want);
+    for (const char* line = text; *line; ) {
+        const char* end = strchr(line, '\n');
+        size_t len = end ? (size_t)(end - line) : strlen(line);
+        const char* body = memchr(line, ']', len);
+        if (body && (size_t)(line + len - (body + 2)) == want_len && strncmp(body + 2, want, want_len) == 0) {
+            found++;
+        }
+        line += len + (end != NULL);
+    }
+    return found;
+}
+
+#ifdef EASS_HAS_THREADS
+static int check_binlog_worker(void* arg) {
+    (void)arg;
+    for (int i = 0; i < 3; i++) {
+        print_binlog("worker {}", numlit(i)); // Written out when the thread exits
+    }
+    return 0;
+}
+#endif
+
+static void check_binlog(void) {
+    const char* path = "eass_check_binlog.bin";
+    CHECK(eass_binlog_open(path) == 0);
+    print_binlog("request {} took {} ms", numlit(42), numlit(3.5f));
+    print_binlog("{} and {}", strlit("short"), strlit("a string too long to be kept inline"));
+    print_binlog("view {}", strview("view text", 4));
+    print_binlog("{1} before {0}", numlit(1), numlit(2));
+    print_binlog_typed("typed {} {}", 7, "text");
+#ifdef EASS_HAS_THREADS
+    thrd_t worker;
+    if (thrd_create(&worker, check_binlog_worker, NULL) == thrd_success) {
+        thrd_join(worker, NULL);
+    }
+#endif
+    eass_binlog_close();
+    print_binlog("after close {}", numlit(1)); // Dropped
+
+    FILE* in = fopen(path, "rb");
+    FILE* out = tmpfile();
+    CHECK(in != NULL && out != NULL);
+    if (in && out) {
+        CHECK(eass_binlog_decode(in, out) == 0);
+        long size = ftell(out);
+        char* text = (char*)calloc((size_t)size + 1, 1);
+        rewind(out);
+        CHECK(text != NULL && fread(text, 1, (size_t)size, out) == (size_t)size);
+        if (text) {
+            CHECK(check_count_records(text, "request 42 took 3.5 ms") == 1);
+            CHECK(check_count_records(text, "short and a string too long to be kept inline") == 1);
+            CHECK(check_count_records(text, "view view") == 1);
+            CHECK(check_count_records(text, "2 before 1") == 1);
+            CHECK(check_count_records(text, "typed 7 text") == 1);
+#ifdef EASS_HAS_THREADS
+            CHECK(check_count_records(text, "worker 0") == 1 && check_count_records(text, "worker 2") == 1);
+#endif
+            CHECK(check_count_records(text, "after close 1") == 0);
+        }
+        free(text);
+    }
+    if (in) fclose(in);
+    if (out) fclose(out);
+    remove(path);
+}
+
+static void check_format_args_failure(void) {
+    // More arguments than fit the stack table, so string_format() allocates one
+    static const char* format = "{}{}{}{}{}{}{}{}{}{}{}{}{}{}{}{}{}";
+    char* warm = string_format(format, strlit("a string too long to be kept inline"), numlit(1), numlit(2), numlit(3),
+                               numlit(4), numlit(5), numlit(6), numlit(7), numlit(8), numlit(9), numlit(10),
+                               numlit(11), numlit(12), numlit(13), numlit(14), numlit(15), numlit(16));
+    CHECK(warm != NULL && strncmp(warm, "a string too long", 17) == 0);
+    free(warm);
+    DynamicValue owned = strlit("another string too long to be kept inline");
+    check_malloc_countdown = 0; // The argument table, the template is cached
+    char* failed = string_format(format, owned, numlit(1), numlit(2), numlit(3), numlit(4), numlit(5), numlit(6),
+                                 numlit(7), numlit(8), numlit(9), numlit(10), numlit(11), numlit(12), numlit(13),
+                                 numlit(14), numlit(15), numlit(16)); // Frees owned; a leak shows up under ASan
+    check_malloc_countdown = -1;
+    CHECK(failed == NULL);
+}
+
+static void check_short_strings(void) {
+    char text[EASS_SSO_SIZE + 1];
+    memset(text, 's', EASS_SSO_SIZE);
+    text[EASS_SSO_SIZE] = '\0';
+    DynamicValue longest = strlit_n(text, EASS_SSO_SIZE - 1); // Fills the inline buffer with its terminator
+    DynamicValue heap = strlit_n(text, EASS_SSO_SIZE);
+    CHECK((longest.flags & EASS_FLAG_INLINE) && !(heap.flags & EASS_FLAG_INLINE));
+    CHECK(strlen(string_value(&longest)) == EASS_SSO_SIZE - 1 && strcmp(string_value(&heap), text) == 0);
+
+    DynamicValue copy = longest; // A struct copy carries its own text
+    copy.value.sso[0] = 'c';
+    CHECK(string_value(&longest)[0] == 's' && string_value(&copy)[0] == 'c');
+    free_dynamic_value(&copy);
+    CHECK(copy.type == EASS_NULL);
+
+    DynamicValue empty = strlit("");
+    CHECK((empty.flags & EASS_FLAG_INLINE) && strcmp(string_value(&empty), "") == 0);
+    char want[2 * EASS_SSO_SIZE + 8];
+    snprintf(want, sizeof(want), "[%.*s|%s|]", EASS_SSO_SIZE - 1, text, text);
+    CHECK_FORMAT(string_format("[{}|{}|{}]", longest, heap, empty), want);
+
+    DynamicArray words = array(0);
+    for (int i = 0; i < 100; i++) {
+        char word[16];
+        snprintf(word, sizeof(word), "w%d", i);
+        words = array_append(&words, strlit(word));
+    }
+    CHECK(words.size == 100 && (words.data[99].flags & EASS_FLAG_INLINE) && strcmp(string_value(&words.data[99]), "w99") == 0);
+    char* joined = array_join(&words, "");
+    CHECK(joined != NULL && strlen(joined) == 10 * 2 + 90 * 3 && strncmp(joined, "w0w1w2", 6) == 0);
+    free(joined);
+    free_dynamic_array(&words);
+}
+
+static void check_string_views(void) {
+    char* text = (char*)malloc(10); // "alpha\nbeta" with no terminator, so a read past a view shows up
+    memcpy(text, "alpha\nbeta", 10);
+    DynamicValue first = strview(text, 5);
+    CHECK(first.type == EASS_STRVIEW && EASS_VIEW_DATA(first) == text && EASS_VIEW_LENGTH(first) == 5);
+    CHECK(string_value(&first) == NULL);
+    DynamicValue same = strlit("alpha");
+    CHECK(value_compare(&first, &same) == 0);
+    free_dynamic_value(&same);
+
+    DynamicArray lines = array(2);
+    lines = array_append(&lines, first);
+    lines = array_append(&lines, strview(text + 6, 4));
+    CHECK_FORMAT(string_format("{} [{:>7}] [{:<6}]", array_value(lines), strview(text, 5), strview(text + 6, 4)),
+                 "Array[alpha, beta] [  alpha] [beta  ]"); // Frees the array, not the text
+    char line[16];
+    CHECK(print_buf(line, sizeof(line), "{}", strview(text + 6, 4)) == 5 && strcmp(line, "beta\n") == 0);
+
+    DynamicValue pooled = intern_value(strview(text, 5));
+    CHECK((pooled.flags & EASS_FLAG_INTERNED) && pooled.value.s == eass_intern("alpha"));
+    CHECK(strview(NULL, 0).error == 0 && strview(NULL, 3).error == 1);
+    free(text);
+}
+
+static void check_compact_values(void) {
+#ifdef EASS_COMPACT_VALUES
+    CHECK(sizeof(DynamicValue) == (sizeof(void*) == 8 ? 16 : 12) && EASS_SSO_SIZE == 8);
+#endif
+    DynamicValue outer = array_value(array(2));
+    for (int i = 0; i < 3; i++) {
+        DynamicValue inner = array_value(array(1));
+        *EASS_ARRAY_OF(inner) = array_append(EASS_ARRAY_OF(inner), numlit(i));
+        *EASS_ARRAY_OF(inner) = array_append(EASS_ARRAY_OF(inner), strlit(i == 2 ? "a string too long to be kept inline" : "s"));
+        *EASS_ARRAY_OF(outer) = array_append(EASS_ARRAY_OF(outer), inner); // Moves inner, its holder included
+    }
+    DynamicArray* rows = EASS_ARRAY_OF(outer);
+    CHECK(rows->size == 3 && EASS_ARRAY_OF(rows->data[2])->size == 2);
+    CHECK(strcmp(string_value(&EASS_ARRAY_OF(rows->data[2])->data[1]), "a string too long to be kept inline") == 0);
+
+    DynamicValue removed = array_remove(rows, 0);
+    CHECK(removed.type == EASS_ARRAY && EASS_ARRAY_OF(removed)->data[0].value.f == 0);
+    free_dynamic_value(&removed);
+
+    DynamicValue view = strview("lengthy", 6);
+    CHECK(EASS_VIEW_LENGTH(view) == 6);
+    *EASS_ARRAY_OF(rows->data[0]) = array_append(EASS_ARRAY_OF(rows->data[0]), view);
+    CHECK_FORMAT(string_format("{}", outer), "Array[Array[1, s, length], Array[2, a string too long to be kept inline]]"); // Frees outer
+}
+
+static void check_packed_strings(void) {
+    DynamicArray names = array_packed(EASS_STORAGE_STRING, 2);
+    names = array_append(&names, strlit("ab")); // Inline, copied to the heap
+    names = array_append(&names, strlit("a string too long to be kept inline"));
+    CHECK(names.storage == EASS_STORAGE_STRING && names.size == 2);
+    CHECK(names.size == 2 && strcmp(names.strings[0], "ab") == 0);
+    CHECK(names.size == 2 && strcmp(names.strings[1], "a string too long to be kept inline") == 0);
+    free_dynamic_array(&names);
+}
+
+static void check_extend_failure(void) {
+    DynamicArray names = array_packed(EASS_STORAGE_STRING, 8);
+    names = array_append(&names, strlit("first"));
+    DynamicValue values[] = {strlit("ab"), strlit("a string too long to be kept inline"), strlit("cd")};
+    check_malloc_countdown = 1; // The copy of "cd" fails after "ab" was copied
+    CHECK(array_extend(&names, values, 3) == -1);
+    check_malloc_countdown = -1;
+    CHECK(names.size == 1 && !names.error && strcmp(names.strings[0], "first") == 0);
+    CHECK(strcmp(string_value(&values[1]), "a string too long to be kept inline") == 0);
+    CHECK(array_extend(&names, values, 3) == 0 && names.size == 4); // The values are still the caller's
+    CHECK_FORMAT(array_join(&names, " "), "first ab a string too long to be kept inline cd");
+    free_dynamic_array(&names);
+}
+
+static void check_interned_arrays(void) {
+    // Packed string arrays copy pooled strings instead of switching to DynamicValue elements
+    DynamicArray names = array_packed(EASS_STORAGE_STRING, 2);
+    names = array_append(&names, strintern("pooled"));
+    CHECK(names.storage == EASS_STORAGE_STRING && names.size == 1 && strcmp(names.strings[0], "pooled") == 0);
+    CHECK(names.size == 1 && names.strings[0] != eass_intern("pooled"));
+    free_dynamic_array(&names);
+
+    const char* long_text = "a string too long to be kept inline";
+    DynamicArray tags = array_packed(EASS_STORAGE_INTERNED, 2);
+    tags = array_append(&tags, strlit("red"));
+    tags = array_append(&tags, strintern("red"));
+    tags = array_append(&tags, strlit(long_text));
+    tags = array_append(&tags, intern_value(strlit(long_text)));
+    tags = array_append(&tags, strview("blue and green", 4));
+    CHECK(tags.storage == EASS_STORAGE_INTERNED && tags.size == 5);
+    CHECK(tags.size == 5 && tags.strings[0] == eass_intern("red") && tags.strings[1] == tags.strings[0]);
+    CHECK(tags.size == 5 && tags.strings[2] == eass_intern(long_text) && tags.strings[3] == tags.strings[2]);
+    CHECK(tags.size == 5 && tags.strings[4] == eass_intern("blue"));
+
+    DynamicValue more[] = {strlit("amber"), strlit(long_text)};
+    CHECK(array_insert_range(&tags, 1, more, 2) == 0 && tags.storage == EASS_STORAGE_INTERNED);
+    DynamicArray heap = array_packed(EASS_STORAGE_STRING, 1);
+    heap = array_append(&heap, strlit("a heap string moved into the pool"));
+    CHECK(array_extend_array(&tags, &heap) == 0 && tags.size == 8 && heap.size == 0);
+    free_dynamic_array(&heap);
+
+    DynamicValue got = array_get(&tags, 0);
+    CHECK(got.type == EASS_STRING && (got.flags & EASS_FLAG_INTERNED) && got.value.s == eass_intern("red"));
+    DynamicValue removed = array_remove(&tags, 1);
+    CHECK(removed.flags & EASS_FLAG_INTERNED);
+    free_dynamic_value(&removed); // Leaves the pooled text alone
+    CHECK(array_sort(&tags) == 0 && tags.storage == EASS_STORAGE_INTERNED);
+    CHECK_FORMAT(array_join(&tags, ","), "a heap string moved into the pool,a string too long to be kept inline,"
+                                         "a string too long to be kept inline,a string too long to be kept inline,"
+                                         "blue,red,red");
+    free_dynamic_array(&tags); // Must not free the pooled text
+    CHECK(strcmp(eass_intern("red"), "red") == 0);
+}
+
+static void check_sort_null_strings(void) {
+    DynamicArray names = array_packed(EASS_STORAGE_STRING, 4);
+    names = array_append(&names, strlit("pear"));
+    names = array_append(&names, strlit("apple"));
+    CHECK(array_resize(&names, 4) == 0); // Leaves two NULL slots
+    CHECK(array_sort(&names) == 0);
+    CHECK(names.size == 4 && names.strings[0] == NULL && names.strings[1] == NULL);
+    CHECK(names.size == 4 && strcmp(names.strings[2], "apple") == 0 && strcmp(names.strings[3], "pear") == 0);
+    free_dynamic_array(&names);
+
+    DynamicValue none = {EASS_NULL, 0, .value.i = 0};
+    DynamicValue null_string = {EASS_STRING, 0, .value.s = NULL};
+    DynamicValue empty = strlit("");
+    CHECK(value_compare(&null_string, &none) == 0);
+    CHECK(value_compare(&null_string, &empty) < 0);
+    CHECK(value_compare(&empty, &null_string) > 0);
+}
+
+// Function to check that a sorted array is in value_compare() order
+static int check_sorted(const DynamicArray* arr) {
+    for (size_t i = 1; i < arr->size; i++) {
+        DynamicValue a = array_get(arr, i - 1);
+        DynamicValue b = array_get(arr, i);
+        if (value_compare(&a, &b) > 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void check_sort_nan_and_zero(void) {
+    // 300 elements takes the radix sort path for packed floats, 8 the comparison sort
+    size_t sizes[] = {8, 300};
+    for (int k = 0; k < 2; k++) {
+        size_t n = sizes[k];
+        DynamicArray packed = array_packed(EASS_STORAGE_FLOAT, n);
+        DynamicArray values = array(n);
+        for (size_t i = 0; i < n; i++) {
+            float x = i % 4 == 0 ? NAN : i % 4 == 1 ? -0.0f : i % 4 == 2 ? 0.0f : (float)n / 2 - (float)i;
+            packed = array_append(&packed, numlit(x));
+            values = array_append(&values, numlit(x));
+        }
+        CHECK(array_sort(&packed) == 0 && array_sort(&values) == 0);
+        CHECK(check_sorted(&packed) && check_sorted(&values));
+        CHECK(isnan(packed.floats[n - 1]) && isnan(values.data[n - 1].value.f));
+        size_t packed_negative = 0, values_negative = 0;
+        for (size_t i = 0; i < n; i++) {
+            packed_negative += packed.floats[i] == 0.0f && signbit(packed.floats[i]);
+            values_negative += values.data[i].value.f == 0.0f && signbit(values.data[i].value.f);
+        }
+        CHECK(packed_negative == (n + 2) / 4 && values_negative == (n + 2) / 4);
+        free_dynamic_array(&packed);
+        free_dynamic_array(&values);
+    }
+}
+
+static void check_reduce_nan_and_zero(void) {
+    // The first zero is -0 in the second SIMD lane, and a +0 lands in the first lane later
+    float samples[] = {NAN, -0.0f, 3.0f, 7.0f, 0.0f, NAN, 3.0f, -0.0f, 0.0f, NAN};
+    size_t n = sizeof(samples) / sizeof(samples[0]);
+    DynamicArray packed = array_packed(EASS_STORAGE_FLOAT, n);
+    DynamicArray values = array(n);
+    for (size_t i = 0; i < n; i++) {
+        packed = array_append(&packed, numlit(samples[i]));
+        values = array_append(&values, numlit(samples[i]));
+    }
+    DynamicArray* both[] = {&packed, &values};
+    for (int k = 0; k < 2; k++) {
+        DynamicValue min = array_min(both[k]);
+        DynamicValue max = array_max(both[k]);
+        CHECK(!min.error && min.value.f == 0.0f && signbit(min.value.f)); // The first zero is -0
+        CHECK(!max.error && max.value.f == 7.0f);
+        CHECK(array_argmin(both[k]).value.i == 1 && array_argmax(both[k]).value.i == 3);
+    }
+    packed.floats[1] = 0.0f;
+    values.data[1].value.f = 0.0f;
+    CHECK(!signbit(array_min(&packed).value.f) && !signbit(array_min(&values).value.f));
+    free_dynamic_array(&packed);
+    free_dynamic_array(&values);
+
+    DynamicArray nans = array_packed(EASS_STORAGE_FLOAT, 9);
+    for (int i = 0; i < 9; i++) {
+        nans = array_append(&nans, numlit(NAN));
+    }
+    CHECK(isnan(array_min(&nans).value.f) && isnan(array_max(&nans).value.f));
+    CHECK(array_argmin(&nans).value.i == 0 && array_argmax(&nans).value.i == 0);
+    free_dynamic_array(&nans);
+}
+
+static void check_sort_parallel(void) {
+    size_t n = 3 * EASS_SORT_PARALLEL_MIN + 7; // Splits unevenly across an odd thread count
+    DynamicArray ints = array_packed(EASS_STORAGE_INT, n);
+    DynamicArray floats = array_packed(EASS_STORAGE_FLOAT, n);
+    DynamicArray values = array(n);
+    unsigned seed = 12345;
+    for (size_t i = 0; i < n; i++) {
+        seed = seed * 1103515245u + 12345u;
+        int x = (int)(seed >> 8) - (1 << 23);
+        ints = array_append(&ints, numlit(x));
+        floats = array_append(&floats, numlit(i % 1000 == 0 ? NAN : (float)x / 7.0f));
+        values = array_append(&values, i % 3 == 0 ? numlit((float)x) : numlit(x));
+    }
+    CHECK(array_sort_parallel(&ints, 3) == 0 && ints.size == n && check_sorted(&ints));
+    CHECK(array_sort_parallel(&floats, 5) == 0 && floats.size == n && check_sorted(&floats));
+    CHECK(array_sort_parallel(&values, 3) == 0 && values.size == n && check_sorted(&values));
+    free_dynamic_array(&ints);
+    free_dynamic_array(&floats);
+    free_dynamic_array(&values);
+}
+
+static void check_deque_wrap_then_grow(void) {
+    DynamicDeque dq = deque(4);
+    for (int i = 0; i < 4; i++) {
+        deque_push_back(&dq, numlit(i));
+    }
+    deque_pop_front(&dq);
+    deque_pop_front(&dq);
+    deque_push_back(&dq, numlit(4)); // Wraps to the start of the ring
+    deque_push_back(&dq, numlit(5));
+    CHECK(dq.capacity == 4 && dq.head == 2);
+    deque_push_back(&dq, numlit(6)); // Grows while wrapped
+    deque_push_front(&dq, numlit(1));
+    CHECK(dq.size == 6 && dq.capacity >= 6);
+    for (int i = 0; i < 6; i++) {
+        DynamicValue val = deque_get(&dq, (size_t)i);
+        CHECK(!val.error && val.value.i == i + 1);
+    }
+    for (int i = 1; i <= 6; i++) {
+        CHECK(deque_pop_front(&dq).value.i == i);
+    }
+    CHECK(dq.size == 0);
+    free_dynamic_deque(&dq);
+}
+
+static void check_packed_ranges(void) {
+    DynamicArray ints = array_packed(EASS_STORAGE_INT, 4);
+    for (int i = 0; i < 6; i++) {
+        ints = array_append(&ints, numlit(i));
+    }
+    DynamicValue more[] = {numlit(10), numlit(11), numlit(12)};
+    CHECK(array_insert_range(&ints, 2, more, 3) == 0 && ints.storage == EASS_STORAGE_INT);
+    CHECK_FORMAT(array_join(&ints, ","), "0,1,10,11,12,2,3,4,5");
+    CHECK(array_remove_range(&ints, 1, 4) == 0 && ints.storage == EASS_STORAGE_INT);
+    CHECK_FORMAT(array_join(&ints, ","), "0,2,3,4,5");
+    CHECK(array_remove_range(&ints, 4, 2) == -1 && ints.size == 5);
+    DynamicValue mixed[] = {numlit(1.5f)};
+    CHECK(array_insert_range(&ints, 5, mixed, 1) == 0 && ints.storage == EASS_STORAGE_VALUES);
+    CHECK_FORMAT(array_join(&ints, ","), "0,2,3,4,5,1.5");
+    free_dynamic_array(&ints);
+
+    DynamicArray names = array_packed(EASS_STORAGE_STRING, 2);
+    names = array_append(&names, strlit("a"));
+    names = array_append(&names, strlit("d"));
+    DynamicValue middle[] = {strlit("b"), strlit("a string too long to be kept inline")};
+    CHECK(array_insert_range(&names, 1, middle, 2) == 0 && names.storage == EASS_STORAGE_STRING);
+    CHECK_FORMAT(array_join(&names, " "), "a b a string too long to be kept inline d");
+    CHECK(array_remove_range(&names, 0, 3) == 0 && names.size == 1 && strcmp(names.strings[0], "d") == 0);
+    free_dynamic_array(&names);
+}
+
+int main(void) {
+    check_format_specs();
+    check_sinks();
+#if defined(EASS_HAS_ASYNC) && (defined(__linux__) || defined(__APPLE__))
+    check_async();
+#endif
+    check_binlog();
+    check_format_args_failure();
+    check_short_strings();
+    check_string_views();
+    check_compact_values();
+    check_packed_strings();
+    check_extend_failure();
+    check_interned_arrays();
+    check_sort_null_strings();
+    check_sort_nan_and_zero();
+    check_reduce_nan_and_zero();
+    check_sort_parallel();
+    check_deque_wrap_then_grow();
+    check_packed_ranges();
+    printf("%d checks, %d failed\n", check_count, check_failures);
+    return check_failures;
+}
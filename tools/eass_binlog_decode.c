@@ -0,0 +1,33 @@
+// Decoder for binary logs written with eass_binlog_open() and print_binlog()
+//
+// Usage: eass_binlog_decode <log file> [output file]
+// Build: cc -std=c11 -I.. eass_binlog_decode.c -o eass_binlog_decode -pthread -lm
+#include "eass.h"
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        fprintf(stderr, "Usage: %s <log file> [output file]\n", argv[0]);
+        return 2;
+    }
+    FILE* in = fopen(argv[1], "rb");
+    if (!in) {
+        perror(argv[1]);
+        return 1;
+    }
+    FILE* out = argc == 3 ? fopen(argv[2], "w") : stdout;
+    if (!out) {
+        perror(argv[2]);
+        fclose(in);
+        return 1;
+    }
+    int result = eass_binlog_decode(in, out);
+    if (result != 0) {
+        const EassError* error = eass_get_last_error();
+        fprintf(stderr, "%s: %s\n", argv[1], error->message);
+    }
+    fclose(in);
+    if (out != stdout) {
+        fclose(out);
+    }
+    return result == 0 ? 0 : 1;
+}